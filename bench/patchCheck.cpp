@@ -0,0 +1,380 @@
+/* patchCheck.cpp
+ *
+ * The purpose of this file is to check that patches and snapshots of the list of snow activities keep every activity
+ * exactly as it was. It checks that:
+ *     - a patch made by writeDelta, writeDeltaSince or diffSnapshots turns the older list into the newer one, for
+ *       rounds of random adds, removes, renames (under the collation) and new locations
+ *     - applying a patch a second time fails and leaves the list as it was
+ *     - a patch that adds or removes the same activity twice is rejected, and leaves the list as it was
+ *     - the reservation requirements entered for a location are exported exactly as they were entered, the standard
+ *       text for every reservation policy parses back to that policy, and common phrases (including negated ones
+ *       like "no permit needed") parse to the right policy
+ *     - saving a list to a snapshot and loading it back exports the same bytes, and every activity can be found in
+ *       the snapshot by name at its rank without loading it, under every collation
+ * It prints each check that fails, and exits with 1 if any of them did.
+ *
+ * Build from the top of the repository with:
+ *     g++ -std=c++17 -O2 -I. bench/patchCheck.cpp snow.cpp -o patchCheck
+ * Usage: ./patchCheck [number of rounds] [directory for temporary files]
+ */
+
+#include "snow.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+using namespace std;
+
+// The number of activities in the older list of each round
+const int ACTIVITIES_PER_ROUND = 2000;
+// The number of each kind of change made to the newer list of each round
+const int CHANGES_PER_ROUND = 30;
+
+char description[] = "Groomed trails through the forest";
+char equipment[] = "Skis, boots, poles";
+// Reservation requirements as a user might enter them, along with the standard text for a few policies
+const char * reservations[] = {"Reservations required", "None", "Permit needed on weekends, call ahead",
+                               "Sno-Park pass needed", "Permit needed", "Required, Fee charged", "maybe?",
+                               "Recommended for groups of 10 or more", "Must book ahead on holidays",
+                               "No permit needed"};
+const int NUM_RESERVATIONS = 10;
+
+int numFailed = 0;
+
+// Reports a check that failed, along with the round, collation or policy it failed for
+void fail(const char * what, int which)
+{
+	printf("FAILED: %s (%d)\n", what, which);
+	++numFailed;
+}
+
+// Returns the whole list as it would be exported, followed by its summary
+string dump(activityList & list)
+{
+	ostringstream out;
+	list.writeToStream(out);
+	catalogSummary summary;
+	list.getSummary(summary);
+	out << summary.numActivities << ' ' << summary.numLocations << ' ' << summary.totalParking << ' '
+	    << summary.minCost << ' ' << summary.maxCost;
+	return out.str();
+}
+
+// Adds a number of random locations to the activity with this name
+void addLocations(activityList & list, char * activityName, int count)
+{
+	char locationName[32];
+	for(int i = 0; i < count; ++i)
+	{
+		sprintf(locationName, "Sno-Park %d", rand() % 50);
+		list.addLocation(activityName, locationName, description,
+		                 const_cast<char *>(reservations[rand() % NUM_RESERVATIONS]), rand() % 100);
+	}
+}
+
+// Copies the name of a random activity in the list into the buffer passed in
+void pickName(activityList & list, char name[])
+{
+	activityData found;
+	list.seek(rand() % list.getCount(), found);
+	ostringstream out;
+	found.writeName(out);
+	strcpy(name, out.str().c_str());
+}
+
+// Returns the contents of a file
+string readFile(const string & fileName)
+{
+	ifstream inFile(fileName, ios::binary);
+	ostringstream contents;
+	contents << inFile.rdbuf();
+	return contents.str();
+}
+
+// Writes the contents passed in to a file
+void writeFile(const string & fileName, const string & contents)
+{
+	ofstream outFile(fileName, ios::binary);
+	outFile << contents;
+}
+
+// Makes a patch with the single change in the patch passed in made twice, by copying the bytes of the change
+string doubleChange(const string & patch)
+{
+	// The header is the magic, version and collation, and the end is a PATCH_END byte and the number of changes
+	const size_t header = 4 + 2 * sizeof(int);
+	const size_t end = 1 + sizeof(int);
+	string change = patch.substr(header, patch.size() - header - end);
+	int count = 2;
+	return patch.substr(0, header) + change + change + string(1, '\0')
+	       + string(reinterpret_cast<char *>(&count), sizeof(count));
+}
+
+// Checks patches between random versions of a list, and that applying a patch twice fails
+void checkDeltas(int round, const string & directory)
+{
+	string olderFile = directory + "/patchCheck-older.snap";
+	string newerFile = directory + "/patchCheck-newer.snap";
+	string deltaFile = directory + "/patchCheck-delta.patch";
+	string diffFile = directory + "/patchCheck-diff.patch";
+	string sinceFile = directory + "/patchCheck-since.patch";
+	char name[64];
+
+	activityList older;
+	for(int i = 0; i < ACTIVITIES_PER_ROUND; ++i)
+	{
+		activityData activity;
+		sprintf(name, "Activity %05d", rand() % 100000);
+		activity.loadActivity(name, description, equipment, rand() % 300);
+		if(older.addActivity(activity) == 1)
+			addLocations(older, name, rand() % 3);
+	}
+	older.writeSnapshot(const_cast<char *>(olderFile.c_str()));
+
+	activityList newer;
+	newer.loadSnapshot(const_cast<char *>(olderFile.c_str()));
+	for(int i = 0; i < CHANGES_PER_ROUND; ++i)
+	{
+		pickName(newer, name);
+		newer.removeActivity(name);
+	}
+	for(int i = 0; i < CHANGES_PER_ROUND; ++i)
+	{
+		activityData activity;
+		sprintf(name, "New Activity %05d", rand() % 100000);
+		activity.loadActivity(name, description, equipment, rand() % 300);
+		if(newer.addActivity(activity) == 1)
+			addLocations(newer, name, rand() % 3);
+	}
+	for(int i = 0; i < CHANGES_PER_ROUND; ++i)
+	{
+		pickName(newer, name);
+		addLocations(newer, name, 1 + rand() % 2);
+	}
+	// Rename activities to names that match under the collation, changing their details as well
+	for(int i = 0; i < CHANGES_PER_ROUND; ++i)
+	{
+		pickName(newer, name);
+		newer.removeActivity(name);
+		for(char * letter = name; *letter; ++letter)
+			*letter = tolower(static_cast<unsigned char>(*letter));
+		char changed[] = "Changed description";
+		activityData activity;
+		activity.loadActivity(name, changed, equipment, rand() % 300);
+		newer.addActivity(activity);
+		if(rand() % 2)
+			addLocations(newer, name, rand() % 3);
+	}
+	newer.writeSnapshot(const_cast<char *>(newerFile.c_str()));
+	string expected = dump(newer);
+
+	int deltaChanges = older.writeDelta(newer, const_cast<char *>(deltaFile.c_str()));
+	int diffChanges = diffSnapshots(const_cast<char *>(olderFile.c_str()), const_cast<char *>(newerFile.c_str()),
+	                                const_cast<char *>(diffFile.c_str()));
+	int sinceChanges = newer.writeDeltaSince(const_cast<char *>(olderFile.c_str()), const_cast<char *>(sinceFile.c_str()));
+	if(deltaChanges < 1 || deltaChanges != diffChanges || diffChanges != sinceChanges)
+		fail("the three ways of making a patch found different changes", round);
+
+	if(older.applyPatch(const_cast<char *>(deltaFile.c_str())) != 1 || dump(older) != expected)
+		fail("a patch from writeDelta did not make the newer list", round);
+	activityList fromDiff;
+	fromDiff.loadSnapshot(const_cast<char *>(olderFile.c_str()));
+	if(fromDiff.applyPatch(const_cast<char *>(diffFile.c_str())) != 1 || dump(fromDiff) != expected)
+		fail("a patch from diffSnapshots did not make the newer list", round);
+	activityList fromSince;
+	fromSince.loadSnapshot(const_cast<char *>(olderFile.c_str()));
+	if(fromSince.applyPatch(const_cast<char *>(sinceFile.c_str())) != 1 || dump(fromSince) != expected)
+		fail("a patch from writeDeltaSince did not make the newer list", round);
+
+	if(older.applyPatch(const_cast<char *>(deltaFile.c_str())) != 0 || dump(older) != expected)
+		fail("applying a patch twice changed the list", round);
+	if(older.writeDelta(newer, const_cast<char *>(deltaFile.c_str())) != 0)
+		fail("a patch between two copies of a list was not empty", round);
+
+	remove(olderFile.c_str());
+	remove(newerFile.c_str());
+	remove(deltaFile.c_str());
+	remove(diffFile.c_str());
+	remove(sinceFile.c_str());
+}
+
+// Checks that patches adding or removing the same activity twice are rejected, under every collation
+void checkDuplicates(const string & directory)
+{
+	string patchFile = directory + "/patchCheck-single.patch";
+	string addTwiceFile = directory + "/patchCheck-add-twice.patch";
+	string removeTwiceFile = directory + "/patchCheck-remove-twice.patch";
+	char name[] = "Ski Touring";
+	for(int collation = COLLATE_BINARY; collation <= COLLATE_ACCENTS; ++collation)
+	{
+		activityList empty, one;
+		empty.setCollation(collation);
+		one.setCollation(collation);
+		activityData activity;
+		activity.loadActivity(name, description, equipment, 25);
+		one.addActivity(activity);
+		addLocations(one, name, 2);
+
+		// Patches adding and removing the activity, with the change made twice. Both are made before either is
+		// applied, so one that is wrongly applied cannot affect the other.
+		empty.writeDelta(one, const_cast<char *>(patchFile.c_str()));
+		writeFile(addTwiceFile, doubleChange(readFile(patchFile)));
+		one.writeDelta(empty, const_cast<char *>(patchFile.c_str()));
+		writeFile(removeTwiceFile, doubleChange(readFile(patchFile)));
+
+		string before = dump(empty);
+		if(empty.applyPatch(const_cast<char *>(addTwiceFile.c_str())) != 0 || dump(empty) != before)
+			fail("a patch adding the same activity twice was applied", collation);
+		before = dump(one);
+		if(one.applyPatch(const_cast<char *>(removeTwiceFile.c_str())) != 0 || dump(one) != before)
+			fail("a patch removing the same activity twice was applied", collation);
+	}
+	remove(patchFile.c_str());
+	remove(addTwiceFile.c_str());
+	remove(removeTwiceFile.c_str());
+}
+
+// Checks that reservation requirements are exported as entered, and that the standard text for every policy parses
+// back to that policy
+void checkReservations()
+{
+	const unsigned char flags[] = {RESERVATION_REQUIRED, RESERVATION_RECOMMENDED, RESERVATION_WEEKENDS,
+	                               RESERVATION_GROUPS, RESERVATION_PERMIT, RESERVATION_FEE, RESERVATION_UNKNOWN};
+	for(int combination = 0; combination < 1 << 7; ++combination)
+	{
+		unsigned char policy = RESERVATION_NONE;
+		for(int i = 0; i < 7; ++i)
+			if(combination & 1 << i)
+				policy |= flags[i];
+		char standardText[128];
+		formatReservation(policy, standardText, sizeof(standardText));
+		if(parseReservation(standardText) != policy)
+			fail("the standard text for a reservation policy parsed to a different policy", policy);
+	}
+
+	// Requirements as a user might enter them, and the policy each one should parse to. Words only count as whole
+	// words, and not in a clause that says "no" or "not".
+	struct
+	{
+		const char * text;
+		unsigned char policy;
+	} phrases[] = {
+		{"No permit needed", RESERVATION_NONE},
+		{"Not required, no pass needed", RESERVATION_NONE},
+		{"Permit not needed", RESERVATION_NONE},
+		{"No fee", RESERVATION_NONE},
+		{"Park at the coffee shop", RESERVATION_UNKNOWN},
+		{"Dogs permitted", RESERVATION_UNKNOWN},
+		{"Sno-Park pass needed", RESERVATION_PERMIT},
+		{"No fee, but a permit is required", RESERVATION_REQUIRED | RESERVATION_PERMIT},
+		{"Not required but recommended", RESERVATION_RECOMMENDED},
+		{"No reservations needed, walk-ins welcome", RESERVATION_NONE},
+		{"Must book ahead on holidays", RESERVATION_REQUIRED | RESERVATION_WEEKENDS},
+		{"$10 fee for groups", RESERVATION_FEE | RESERVATION_GROUPS}};
+	const int numPhrases = sizeof(phrases) / sizeof(phrases[0]);
+	for(int i = 0; i < numPhrases; ++i)
+		if(parseReservation(phrases[i].text) != phrases[i].policy)
+			fail("reservation requirements parsed to the wrong policy", i);
+
+	activityList list;
+	char name[] = "Snowshoeing";
+	activityData activity;
+	activity.loadActivity(name, description, equipment, 0);
+	list.addActivity(activity);
+	for(int i = 0; i < NUM_RESERVATIONS; ++i)
+	{
+		char locationName[32];
+		sprintf(locationName, "Trailhead %d", i);
+		list.addLocation(name, locationName, description, const_cast<char *>(reservations[i]), i);
+	}
+	ostringstream out;
+	list.lookup(name, out);
+	for(int i = 0; i < NUM_RESERVATIONS; ++i)
+		if(out.str().find(string("Reservation Requirements: ") + reservations[i] + "\n") == string::npos)
+			fail("reservation requirements were not exported as entered", i);
+}
+
+// Checks that saving a list to a snapshot and loading it back exports the same bytes, and that every activity can be
+// found in the snapshot by name without loading it, under every collation
+void checkSnapshots(const string & directory)
+{
+	string snapshotFile = directory + "/patchCheck-reload.snap";
+	char name[64];
+	activityList list;
+	// The numbers are all different, so no two names match even when case is ignored
+	for(int i = 0; i < ACTIVITIES_PER_ROUND / 4; ++i)
+	{
+		activityData activity;
+		sprintf(name, i % 2 ? "Cross-Country Skiing %04d" : "cross-country skiing %04d", i * 7919 % 10000);
+		activity.loadActivity(name, description, equipment, rand() % 300);
+		list.addActivity(activity);
+		addLocations(list, name, rand() % 4);
+	}
+	for(int collation = COLLATE_BINARY; collation <= COLLATE_ACCENTS; ++collation)
+	{
+		if(list.setCollation(collation) != 1)
+		{
+			fail("a list could not be put in order under a collation", collation);
+			continue;
+		}
+		list.writeSnapshot(const_cast<char *>(snapshotFile.c_str()));
+		activityList reloaded;
+		if(reloaded.loadSnapshot(const_cast<char *>(snapshotFile.c_str())) != 1 || dump(reloaded) != dump(list)
+		   || reloaded.getCollation() != collation)
+			fail("a list loaded from a snapshot did not export the same bytes", collation);
+
+		snapshotReader reader;
+		if(reader.open(const_cast<char *>(snapshotFile.c_str())) != 1 || reader.getCount() != list.getCount())
+		{
+			fail("a snapshot could not be opened to search it", collation);
+			continue;
+		}
+		int numWrong = 0;
+		for(int rank = 0; rank < list.getCount(); ++rank)
+		{
+			activityData found;
+			list.seek(rank, found);
+			ostringstream out;
+			found.writeName(out);
+			strcpy(name, out.str().c_str());
+			if(reader.rankOf(name) != rank)
+				++numWrong;
+			// Under a collation that ignores case, the name in uppercase is the same activity
+			for(char * letter = name; *letter; ++letter)
+				*letter = toupper(static_cast<unsigned char>(*letter));
+			if(collation != COLLATE_BINARY && reader.rankOf(name) != rank)
+				++numWrong;
+		}
+		const char * missing[] = {"", "A", "Cross-Country Skiing 10000", "cross-country skiing 0000 ", "zzz"};
+		for(int i = 0; i < 5; ++i)
+			if(reader.rankOf(const_cast<char *>(missing[i])) != -1)
+				++numWrong;
+		if(numWrong)
+			fail("searching a snapshot by name did not find activities at their rank", collation);
+	}
+	remove(snapshotFile.c_str());
+}
+
+int main(int argc, char * argv[])
+{
+	int numRounds = argc > 1 ? atoi(argv[1]) : 10;
+	string directory = argc > 2 ? argv[2] : "/tmp";
+	if(numRounds < 1)
+	{
+		cout << "Usage: " << argv[0] << " [number of rounds] [directory for temporary files]" << endl;
+		return 1;
+	}
+	srand(7);
+	for(int round = 0; round < numRounds; ++round)
+		checkDeltas(round, directory);
+	checkDuplicates(directory);
+	checkReservations();
+	checkSnapshots(directory);
+	if(numFailed)
+	{
+		printf("%d checks failed\n", numFailed);
+		return 1;
+	}
+	printf("All checks passed (%d rounds of patches)\n", numRounds);
+	return 0;
+}
@@ -0,0 +1,173 @@
+/* shardBench.cpp
+ *
+ * The purpose of this file is to time the sharded list of snow activities with different numbers of threads, next to
+ * a single activityList. It times adding activities from several threads at once, checking for activities by name,
+ * exporting the whole list, and summarizing the whole list, and prints the throughput of each. It then exports the
+ * list while another thread summarizes it, to check that the two can scan the list at the same time. The numbers only
+ * say anything about scaling when the machine has at least as many cores as the most threads tried; on a machine with
+ * fewer cores, the extra threads just take turns, and the sharded list is expected to be a little slower.
+ *
+ * Build from the top of the repository with:
+ *     g++ -std=c++17 -O2 -pthread -I. bench/shardBench.cpp snow.cpp shard.cpp -o shardBench
+ * Usage: ./shardBench [number of activities] [most threads to try]
+ */
+
+#include "shard.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+using namespace std;
+
+// The number of shards created for each thread- more shards than threads keeps threads from waiting on each other
+const int SHARDS_PER_THREAD = 4;
+// The number of times each export is timed
+const int EXPORT_RUNS = 3;
+// The number of exports run while another thread summarizes the same list
+const int CONCURRENT_EXPORTS = 5;
+
+// Returns the number of seconds since the first time this function was called
+double now()
+{
+	static chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Loads each of the activities used by the benchmark. The names share a long prefix, like the names of real
+// activities, and are generated in a scrambled order so the activities are not added in alphabetical order.
+activityData * makeActivities(int numActivities)
+{
+	activityData * activities = new activityData[numActivities];
+	char name[64];
+	char description[] = "Groomed trails through the forest, suitable for all skill levels";
+	char equipment[] = "Skis, boots, poles";
+	for(int i = 0; i < numActivities; ++i)
+	{
+		sprintf(name, "Cross-Country Skiing - Trail %08d", static_cast<int>((i * 2654435761u) % 100000000));
+		activities[i].loadActivity(name, description, equipment, 10 + i % 90);
+	}
+	return activities;
+}
+
+// Times exporting a list to the output file a few times, and returns the fastest time in seconds. The first export
+// after a large list is built tends to be slow while memory is reorganized, which would otherwise skew the results.
+template <class listType>
+double timeExport(listType & list, char * outputFile)
+{
+	double best = 0;
+	for(int i = 0; i < EXPORT_RUNS; ++i)
+	{
+		double start = now();
+		list.writeToFile(outputFile);
+		double elapsed = now() - start;
+		if(!i || elapsed < best)
+			best = elapsed;
+	}
+	return best;
+}
+
+// Runs the same work on numThreads threads at once, where thread t handles every activity i with i % numThreads == t
+void runThreads(int numThreads, int numActivities, const function<void(int)> & work)
+{
+	thread * threads = new thread[numThreads];
+	for(int t = 0; t < numThreads; ++t)
+		threads[t] = thread([&, t]()
+		{
+			for(int i = t; i < numActivities; i += numThreads)
+				work(i);
+		});
+	for(int t = 0; t < numThreads; ++t)
+		threads[t].join();
+	delete [] threads;
+}
+
+int main(int argc, char * argv[])
+{
+	int numActivities = argc > 1 ? atoi(argv[1]) : 200000;
+	int maxThreads = argc > 2 ? atoi(argv[2]) : thread::hardware_concurrency();
+	if(numActivities < 1 || maxThreads < 1)
+	{
+		cout << "Usage: " << argv[0] << " [number of activities] [most threads to try]" << endl;
+		return 1;
+	}
+	activityData * activities = makeActivities(numActivities);
+	char outputFile[] = "/dev/null";
+	printf("%d activities, %u hardware threads\n", numActivities, thread::hardware_concurrency());
+	printf("%-24s %8s %14s %14s %12s %12s\n", "list", "threads", "adds/s", "lookups/s", "export ms", "summary us");
+
+	// A single activityList can only be used by one thread at a time
+	catalogSummary expected;
+	{
+		activityList single;
+		double start = now();
+		for(int i = 0; i < numActivities; ++i)
+			single.addActivity(activities[i]);
+		double added = now();
+		for(int i = 0; i < numActivities; ++i)
+			single.checkMatch(activities[i]);
+		double checked = now();
+		double exported = timeExport(single, outputFile);
+		double summaryStart = now();
+		single.getSummary(expected);
+		double summarized = now() - summaryStart;
+		printf("%-24s %8d %14.0f %14.0f %12.1f %12.1f\n", "activityList", 1, numActivities / (added - start),
+		       numActivities / (checked - added), exported * 1000, summarized * 1000000);
+	}
+
+	for(int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		shardedActivityList sharded(numThreads * SHARDS_PER_THREAD, numThreads);
+		double start = now();
+		runThreads(numThreads, numActivities, [&](int i) { sharded.addActivity(activities[i]); });
+		double added = now();
+		runThreads(numThreads, numActivities, [&](int i) { sharded.checkMatch(activities[i]); });
+		double checked = now();
+		double exported = timeExport(sharded, outputFile);
+		catalogSummary summary;
+		double summaryStart = now();
+		sharded.getSummary(summary);
+		double summarized = now() - summaryStart;
+		if(sharded.getCount() != numActivities)
+			printf("Error: expected %d activities, found %d\n", numActivities, sharded.getCount());
+		if(summary.numActivities != expected.numActivities || summary.minCost != expected.minCost ||
+		   summary.maxCost != expected.maxCost || summary.averageCost - expected.averageCost > 0.01f ||
+		   expected.averageCost - summary.averageCost > 0.01f)
+			printf("Error: the sharded summary does not match the summary of a single list\n");
+		char label[32];
+		sprintf(label, "sharded (%d shards)", sharded.getNumShards());
+		printf("%-24s %8d %14.0f %14.0f %12.1f %12.1f\n", label, numThreads, numActivities / (added - start),
+		       numActivities / (checked - added), exported * 1000, summarized * 1000000);
+	}
+
+	// Export the list on one thread while another summarizes it over and over. Both scan the whole list using the pool
+	// of threads, so this checks that the two can run at the same time without waiting on each other forever.
+	{
+		shardedActivityList sharded(maxThreads * SHARDS_PER_THREAD, maxThreads);
+		runThreads(maxThreads, numActivities, [&](int i) { sharded.addActivity(activities[i]); });
+		atomic<bool> exporting(true);
+		int numSummaries = 0;
+		int numWrong = 0;
+		double start = now();
+		thread summarizer([&]()
+		{
+			while(exporting)
+			{
+				catalogSummary summary;
+				sharded.getSummary(summary);
+				if(summary.numActivities != expected.numActivities)
+					++numWrong;
+				++numSummaries;
+			}
+		});
+		for(int i = 0; i < CONCURRENT_EXPORTS; ++i)
+			sharded.writeToFile(outputFile);
+		exporting = false;
+		summarizer.join();
+		printf("%d exports alongside %d summaries on %d threads: %.1f ms\n", CONCURRENT_EXPORTS, numSummaries,
+		       maxThreads, (now() - start) * 1000);
+		if(numWrong)
+			printf("Error: %d summaries made during an export were wrong\n", numWrong);
+	}
+	delete [] activities;
+	return 0;
+}
@@ -1,15 +1,63 @@
 /* Jack Timmons, jackt@pdx.edu, CS163 Program 1, 9 September 2024
  *
- * The purpose of this file is to serve as the main function of our snow activities program. Here we will call the 
- * necessary functions to manage our client program and ADT to specification. 
+ * The purpose of this file is to serve as the main function of our snow activities program. Here we will call the
+ * necessary functions to manage our client program and ADT to specification.
+ *
+ * With no arguments, the program runs the interactive menu. It can also be run as a catalog server, as a load
+ * generator for testing a running server, or to look up an activity in a snapshot without loading it:
+ *     main --serve <socket path> [snapshot file to load]
+ *     main --load <socket path> [number of requests] [pipeline depth]
+ *     main --find <snapshot file> <activity name>
  */
 
 #include "snow.h"
+#include "server.h"
+#include <cstdlib>
 using namespace std;
 
-int main()
+int main(int argc, char * argv[])
 {
 	activityList myList;
+	if(argc > 2 && strcmp(argv[1], "--serve") == 0)
+	{
+		if(argc > 3 && myList.loadSnapshot(argv[3]) != 1)
+		{
+			cout << "Error loading snapshot " << argv[3] << endl;
+			return 1;
+		}
+		return runServer(myList, argv[2]) < 0 ? 1 : 0;
+	}
+	if(argc > 2 && strcmp(argv[1], "--load") == 0)
+	{
+		int numRequests = argc > 3 ? atoi(argv[3]) : 100000;
+		int pipelineDepth = argc > 4 ? atoi(argv[4]) : 64;
+		return runLoadClient(argv[2], numRequests, pipelineDepth) < 0 ? 1 : 0;
+	}
+	if(argc > 3 && strcmp(argv[1], "--find") == 0)
+	{
+		snapshotReader reader;
+		if(reader.open(argv[2]) != 1)
+		{
+			cout << "Error reading snapshot " << argv[2] << endl;
+			return 1;
+		}
+		int rank = reader.rankOf(argv[3]);
+		if(rank < 0)
+		{
+			cout << argv[3] << " is not in " << argv[2] << endl;
+			return 1;
+		}
+		cout << argv[3] << " is activity " << rank + 1 << " of " << reader.getCount() << " in " << argv[2] << endl;
+		return 0;
+	}
+	if(argc > 1)
+	{
+		cout << "Usage: " << argv[0] << endl
+		     << "       " << argv[0] << " --serve <socket path> [snapshot file to load]" << endl
+		     << "       " << argv[0] << " --load <socket path> [number of requests] [pipeline depth]" << endl
+		     << "       " << argv[0] << " --find <snapshot file> <activity name>" << endl;
+		return 1;
+	}
 	displayMenu();
 	mainMenu(myList);
 	return 0;
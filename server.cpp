@@ -0,0 +1,671 @@
+/* server.cpp
+ *
+ * The purpose of this file is to hold the source code for the catalog server and the load generator client. The
+ * protocol they use to talk to each other is described in server.h.
+ */
+
+#include "server.h"
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <poll.h>
+using namespace std;
+
+// Set by the signal handler when the server should stop
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+	stopRequested = 1;
+}
+
+// Returns the number of seconds since the first time this function was called
+static double now()
+{
+	static chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Helper functions for building frames. Numbers are appended in the byte order of the machine, and strings as a
+// 2 byte length followed by their characters.
+template <class numberType>
+static void appendNumber(string & buffer, numberType value)
+{
+	buffer.append(reinterpret_cast<char *>(&value), sizeof(value));
+}
+
+static void appendString(string & buffer, const char * text)
+{
+	size_t length = strlen(text);
+	if(length > 65535)
+		length = 65535;
+	appendNumber(buffer, static_cast<unsigned short>(length));
+	buffer.append(text, length);
+}
+
+// This class will read the fields of a frame one at a time. If a field runs past the end of the frame, the read
+// fails, and so does every read after it, so a whole request can be decoded before checking whether it was valid.
+class frameReader
+{
+	public:
+		frameReader(const char * passedData, int passedLength)
+		{
+			data = passedData;
+			length = passedLength;
+			position = 0;
+			ok = true;
+		}
+
+		template <class numberType>
+		bool readNumber(numberType & value)
+		{
+			if(!ok || length - position < static_cast<int>(sizeof(value)))
+				return ok = false;
+			memcpy(&value, data + position, sizeof(value));
+			position += sizeof(value);
+			return true;
+		}
+
+		bool readString(string & text)
+		{
+			unsigned short textLength;
+			if(!readNumber(textLength) || length - position < textLength)
+				return ok = false;
+			text.assign(data + position, textLength);
+			position += textLength;
+			return true;
+		}
+
+		// Whether every field was read, with nothing left over
+		bool finished()
+		{
+			return ok && position == length;
+		}
+
+	private:
+		const char * data; // The fields of the frame
+		int length; // The number of bytes in the frame
+		int position; // The number of bytes read so far
+		bool ok; // Whether every read so far has succeeded
+};
+
+/******************** catalogServer Class: *******************************************/
+
+// This function serves as the constructor for the catalogServer class. The server does not own the list it serves.
+catalogServer::catalogServer(activityList & passedList) : myList(passedList)
+{
+	epollFd = -1;
+	connections = nullptr;
+}
+
+// This function serves as the destructor for the catalogServer class, and closes any connections still open.
+catalogServer::~catalogServer()
+{
+	while(connections)
+		closeConnection(connections);
+	if(epollFd >= 0)
+		close(epollFd);
+}
+
+// This function will listen for connections on a Unix domain socket at the passed path, replacing any socket file
+// already there, and will handle requests until the server receives SIGINT or SIGTERM. All of the sockets are
+// non-blocking, and a single epoll instance tells us which of them are ready, so one thread can serve every client.
+// Returns -1 if the socket could not be set up, or 1 once the server has stopped.
+int catalogServer::run(char * socketPath)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(strlen(socketPath) >= sizeof(address.sun_path))
+		return -1;
+	strcpy(address.sun_path, socketPath);
+
+	// Stop cleanly on SIGINT or SIGTERM, and report closed connections as errors rather than being killed by SIGPIPE
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = requestStop;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+	stopRequested = 0;
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(listenFd < 0)
+		return -1;
+	unlink(socketPath);
+	if(bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(listenFd, SOMAXCONN) < 0)
+	{
+		close(listenFd);
+		return -1;
+	}
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr; // The listening socket is the only one without a connection
+	if(epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0)
+	{
+		close(listenFd);
+		unlink(socketPath);
+		return -1;
+	}
+	cout << "Serving " << myList.getCount() << " activities on " << socketPath << endl;
+
+	const int MAX_EVENTS = 64;
+	epoll_event events[MAX_EVENTS];
+	while(!stopRequested)
+	{
+		int numEvents = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+		if(numEvents < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		for(int i = 0; i < numEvents; ++i)
+		{
+			serverConnection * connection = static_cast<serverConnection *>(events[i].data.ptr);
+			if(!connection)
+			{
+				acceptAll(listenFd);
+				continue;
+			}
+			bool failed = events[i].events & EPOLLERR;
+			if(!failed && (events[i].events & (EPOLLIN | EPOLLHUP)))
+				failed = readAll(connection) < 0;
+			// Handle the requests received and send the responses right away- often they fit in the socket buffer
+			// and we never need EPOLLOUT. If handling stopped because too many responses were waiting, and sending
+			// made room for more, carry on with the requests that are left.
+			while(!failed)
+			{
+				int handled = handleAll(connection);
+				failed = handled < 0 || writeAll(connection) < 0;
+				if(handled < 1 || connection -> output.size() - connection -> outputSent >= SERVER_MAX_PENDING)
+					break;
+			}
+			if(failed)
+				closeConnection(connection);
+			else
+				updateInterest(connection);
+		}
+	}
+
+	while(connections)
+		closeConnection(connections);
+	close(epollFd);
+	epollFd = -1;
+	close(listenFd);
+	unlink(socketPath);
+	cout << "Server stopped" << endl;
+	return 1;
+}
+
+// This function will accept every connection waiting on the listening socket, and start watching each of them for
+// requests. Returns the number of connections accepted.
+int catalogServer::acceptAll(int listenFd)
+{
+	int accepted = 0;
+	while(true)
+	{
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if(fd < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return accepted;
+		}
+		serverConnection * connection = new serverConnection;
+		connection -> fd = fd;
+		connection -> outputSent = 0;
+		connection -> events = EPOLLIN;
+		connection -> peerClosed = false;
+		epoll_event event;
+		event.events = connection -> events;
+		event.data.ptr = connection;
+		if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+		{
+			close(fd);
+			delete connection;
+			continue;
+		}
+		// Add the connection to the front of the list of open connections
+		connection -> previous = nullptr;
+		connection -> next = connections;
+		if(connections)
+			connections -> previous = connection;
+		connections = connection;
+		++accepted;
+	}
+}
+
+// This function will read everything the client has sent so far, but never let the connection hold more than
+// SERVER_MAX_INPUT bytes of requests that have not been handled yet. Whatever the client sends beyond that stays in
+// the socket (and, once the socket is full, with the client) until the requests already held have been handled.
+// Returns -1 if the connection failed, or 1 otherwise.
+int catalogServer::readAll(serverConnection * connection)
+{
+	char chunk[65536];
+	while(!connection -> peerClosed && connection -> input.size() < SERVER_MAX_INPUT)
+	{
+		size_t room = SERVER_MAX_INPUT - connection -> input.size();
+		ssize_t received = read(connection -> fd, chunk, room < sizeof(chunk) ? room : sizeof(chunk));
+		if(received > 0)
+			connection -> input.append(chunk, received);
+		else if(received == 0)
+			connection -> peerClosed = true;
+		else if(errno == EINTR)
+			continue;
+		else if(errno == EAGAIN || errno == EWOULDBLOCK)
+			break;
+		else
+			return -1;
+	}
+	return 1;
+}
+
+// This function will handle each complete request received on a connection in the order received. A request split
+// across reads is kept until the rest of it arrives. The responses are only added to the connection's output here,
+// so the responses to every request handled in one call are sent back together. Handling stops once
+// SERVER_MAX_PENDING bytes of responses are waiting, leaving the rest of the requests for after some are sent, so a
+// client that sends many requests without reading the responses cannot make the server hold them all. Returns -1 if
+// the client sent a frame that is too large, 1 if requests were left because too many responses are waiting, or 0
+// if every complete request was handled.
+int catalogServer::handleAll(serverConnection * connection)
+{
+	string & input = connection -> input;
+	string & output = connection -> output;
+	size_t position = 0;
+	int stopped = 0;
+	while(input.size() - position >= sizeof(unsigned int))
+	{
+		if(output.size() - connection -> outputSent >= SERVER_MAX_PENDING)
+		{
+			stopped = 1;
+			break;
+		}
+		unsigned int length;
+		memcpy(&length, input.data() + position, sizeof(length));
+		if(length > SERVER_MAX_FRAME)
+			return -1;
+		if(input.size() - position - sizeof(length) < length)
+			break;
+		handleRequest(input.data() + position + sizeof(length), length, output);
+		position += sizeof(length) + length;
+	}
+	input.erase(0, position);
+	return stopped;
+}
+
+// This function will send as much of the waiting responses as the socket will take without blocking. Returns -1
+// if the connection failed, or 1 otherwise.
+int catalogServer::writeAll(serverConnection * connection)
+{
+	string & output = connection -> output;
+	while(connection -> outputSent < output.size())
+	{
+		ssize_t sent = send(connection -> fd, output.data() + connection -> outputSent,
+		                    output.size() - connection -> outputSent, MSG_NOSIGNAL);
+		if(sent > 0)
+			connection -> outputSent += sent;
+		else if(sent < 0 && errno == EINTR)
+			continue;
+		else if(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+		else
+			return -1;
+	}
+	// Drop the responses that have been sent
+	if(connection -> outputSent == output.size())
+	{
+		output.clear();
+		connection -> outputSent = 0;
+	}
+	else if(connection -> outputSent > SERVER_MAX_PENDING / 2)
+	{
+		output.erase(0, connection -> outputSent);
+		connection -> outputSent = 0;
+	}
+	return 1;
+}
+
+// This function will set which events epoll watches a connection for. We watch for requests unless too many
+// responses are already waiting, too many requests are already held, or the client has finished sending, and for
+// room to write only while responses are waiting, so epoll does not keep waking us up for a connection we have
+// nothing to do with. A connection whose client has finished sending is closed once all of its responses have been
+// sent. Returns 0 if the connection was closed, or 1 otherwise.
+int catalogServer::updateInterest(serverConnection * connection)
+{
+	size_t pending = connection -> output.size() - connection -> outputSent;
+	if(connection -> peerClosed && !pending)
+	{
+		closeConnection(connection);
+		return 0;
+	}
+	unsigned int events = 0;
+	if(!connection -> peerClosed && pending < SERVER_MAX_PENDING && connection -> input.size() < SERVER_MAX_INPUT)
+		events |= EPOLLIN;
+	if(pending)
+		events |= EPOLLOUT;
+	if(events != connection -> events)
+	{
+		epoll_event event;
+		event.events = events;
+		event.data.ptr = connection;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, connection -> fd, &event);
+		connection -> events = events;
+	}
+	return 1;
+}
+
+// This function will close a connection, remove it from the list of open connections, and release it.
+void catalogServer::closeConnection(serverConnection * connection)
+{
+	// Closing the socket also removes it from epoll
+	close(connection -> fd);
+	if(connection -> previous)
+		connection -> previous -> next = connection -> next;
+	else
+		connections = connection -> next;
+	if(connection -> next)
+		connection -> next -> previous = connection -> previous;
+	delete connection;
+}
+
+// This function will decode one request, call the activityList function that handles it, and append the response
+// to the output passed in. The response holds the request id, the value returned by the activityList function as
+// the status, and any text that function displayed as the payload. A request that cannot be decoded gets a status
+// of STATUS_BAD_REQUEST.
+void catalogServer::handleRequest(const char * frame, int length, string & output)
+{
+	frameReader reader(frame, length);
+	unsigned int requestId = 0;
+	unsigned char opcode = 0;
+	reader.readNumber(requestId);
+	reader.readNumber(opcode);
+
+	int status = STATUS_BAD_REQUEST;
+	ostringstream payload;
+	string name, locationName, description, equipment;
+	switch(opcode)
+	{
+		case OP_ADD_ACTIVITY:
+		{
+			float cost;
+			if(reader.readString(name) && reader.readString(description) && reader.readString(equipment)
+			   && reader.readNumber(cost) && reader.finished())
+			{
+				activityData newActivity;
+				if(newActivity.loadActivity(&name[0], &description[0], &equipment[0], cost))
+					status = myList.addActivity(newActivity);
+				else
+					status = 0;
+			}
+		}
+			break;
+		case OP_REMOVE_ACTIVITY:
+		{
+			if(reader.readString(name) && reader.finished())
+				status = myList.removeActivity(&name[0]);
+		}
+			break;
+		case OP_LOOKUP:
+		{
+			if(reader.readString(name) && reader.finished())
+				status = myList.lookup(&name[0], payload);
+		}
+			break;
+		case OP_ADD_LOCATION:
+		{
+			string reservation;
+			int numSpots;
+			if(reader.readString(name) && reader.readString(locationName) && reader.readString(description)
+			   && reader.readString(reservation) && reader.readNumber(numSpots) && reader.finished())
+				status = myList.addLocation(&name[0], &locationName[0], &description[0], &reservation[0], numSpots);
+		}
+			break;
+		case OP_RESERVATION:
+		{
+			if(reader.readString(name) && reader.readString(locationName) && reader.finished())
+				status = myList.displayReservation(&name[0], &locationName[0], payload);
+		}
+			break;
+		case OP_PAGE:
+		{
+			int rank, pageSize;
+			if(reader.readNumber(rank) && reader.readNumber(pageSize) && reader.finished())
+			{
+				activityCursor cursor;
+				if(pageSize > SERVER_MAX_PAGE)
+					pageSize = SERVER_MAX_PAGE;
+				status = myList.seekCursor(cursor, rank) ? myList.displayPage(cursor, pageSize, payload) : -1;
+			}
+		}
+			break;
+		case OP_COUNT:
+		{
+			if(reader.finished())
+				status = myList.getCount();
+		}
+			break;
+		case OP_RANK:
+		{
+			if(reader.readString(name) && reader.finished())
+				status = myList.rankOf(&name[0]);
+		}
+			break;
+	}
+
+	string text = payload.str();
+	unsigned int responseLength = sizeof(requestId) + sizeof(status) + sizeof(unsigned int) + text.size();
+	appendNumber(output, responseLength);
+	appendNumber(output, requestId);
+	appendNumber(output, status);
+	appendNumber(output, static_cast<unsigned int>(text.size()));
+	output += text;
+}
+
+// This function will serve the passed list of activities on the socket at the passed path until interrupted.
+// Returns -1 if the server could not be started, or 1 once it has stopped.
+int runServer(activityList & myList, char * socketPath)
+{
+	catalogServer server(myList);
+	int success = server.run(socketPath);
+	if(success < 0)
+		cout << "Error starting server- could not listen on " << socketPath << endl;
+	return success;
+}
+
+/******************** Load generator client: ******************************************/
+
+// This function will append the request numbered i to a batch of requests for the load generator. Out of every ten
+// requests, two add a new activity, one adds a location to the newest activity, four look up one of the activities
+// added so far, one asks for reservation requirements, one asks for a page of activities, and one asks for the rank of
+// an activity. The activities are named after the process id, so several load generators can run at once.
+static void appendLoadRequest(string & batch, unsigned int i, int & numAdded)
+{
+	char name[64];
+	char locationName[] = "Timberline Lodge";
+	char description[] = "Load generator test data";
+	char equipment[] = "Snowshoes";
+	char reservation[] = "Required on weekends";
+	string request;
+	appendNumber(request, i);
+	int pick = numAdded ? (i * 2654435761u) % numAdded : 0;
+	switch(i % 10)
+	{
+		case 0:
+		case 1:
+			sprintf(name, "Load Test %d - Activity %08d", getpid(), numAdded++);
+			appendNumber(request, static_cast<unsigned char>(OP_ADD_ACTIVITY));
+			appendString(request, name);
+			appendString(request, description);
+			appendString(request, equipment);
+			appendNumber(request, 25.0f);
+			break;
+		case 2:
+			sprintf(name, "Load Test %d - Activity %08d", getpid(), numAdded - 1);
+			appendNumber(request, static_cast<unsigned char>(OP_ADD_LOCATION));
+			appendString(request, name);
+			appendString(request, locationName);
+			appendString(request, description);
+			appendString(request, reservation);
+			appendNumber(request, 120);
+			break;
+		case 7:
+			sprintf(name, "Load Test %d - Activity %08d", getpid(), pick);
+			appendNumber(request, static_cast<unsigned char>(OP_RESERVATION));
+			appendString(request, name);
+			appendString(request, locationName);
+			break;
+		case 8:
+			appendNumber(request, static_cast<unsigned char>(OP_PAGE));
+			appendNumber(request, pick);
+			appendNumber(request, 10);
+			break;
+		case 9:
+			sprintf(name, "Load Test %d - Activity %08d", getpid(), pick);
+			appendNumber(request, static_cast<unsigned char>(OP_RANK));
+			appendString(request, name);
+			break;
+		default:
+			sprintf(name, "Load Test %d - Activity %08d", getpid(), pick);
+			appendNumber(request, static_cast<unsigned char>(OP_LOOKUP));
+			appendString(request, name);
+	}
+	appendNumber(batch, static_cast<unsigned int>(request.size()));
+	batch += request;
+}
+
+// This function will connect to the server on the socket at the passed path and send it numRequests requests,
+// keeping up to pipelineDepth requests in flight at once: whenever the last batch has been sent and there is room,
+// it builds a batch of new requests, and poll tells it when it can send more of the batch or read responses. The time from sending each request to receiving its
+// response is recorded, and the throughput and latency percentiles are reported once every response has arrived.
+// Returns -1 if the client could not connect or the connection failed, or 1 on success.
+int runLoadClient(char * socketPath, int numRequests, int pipelineDepth)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(numRequests < 1 || pipelineDepth < 1 || strlen(socketPath) >= sizeof(address.sun_path))
+		return -1;
+	strcpy(address.sun_path, socketPath);
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+	{
+		cout << "Error connecting to server on " << socketPath << endl;
+		if(fd >= 0)
+			close(fd);
+		return -1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	double * sentAt = new double[numRequests];
+	double * latency = new double[numRequests];
+	int sent = 0, received = 0, numAdded = 0, badRequests = 0;
+	string batch, input;
+	size_t written = 0;
+	char chunk[65536];
+	int success = 1;
+	double start = now();
+	while(success > 0 && received < numRequests)
+	{
+		// Once the last batch has gone out, fill the pipeline again
+		if(written == batch.size())
+		{
+			batch.clear();
+			written = 0;
+			int firstInBatch = sent;
+			while(sent < numRequests && sent - received < pipelineDepth)
+				appendLoadRequest(batch, sent++, numAdded);
+			double sendTime = now();
+			for(int i = firstInBatch; i < sent; ++i)
+				sentAt[i] = sendTime;
+		}
+
+		// Wait until the server will take more of the batch or has responses for us. Sending and reading are both
+		// driven from here, so a deep pipeline can't leave us stuck in send while the server, its own output queue
+		// full, waits for us to read.
+		pollfd ready;
+		ready.fd = fd;
+		ready.events = POLLIN | (written < batch.size() ? POLLOUT : 0);
+		ready.revents = 0;
+		if(poll(&ready, 1, -1) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			success = -1;
+			break;
+		}
+		if(ready.revents & POLLOUT)
+		{
+			ssize_t count = send(fd, batch.data() + written, batch.size() - written, MSG_NOSIGNAL | MSG_DONTWAIT);
+			if(count > 0)
+				written += count;
+			else if(count == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK))
+			{
+				success = -1;
+				break;
+			}
+		}
+		if(!(ready.revents & (POLLIN | POLLHUP | POLLERR)))
+			continue;
+
+		// Read whatever responses have arrived
+		ssize_t count = recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+		if(count < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+			continue;
+		if(count <= 0)
+		{
+			success = -1;
+			break;
+		}
+		input.append(chunk, count);
+		double receiveTime = now();
+		size_t position = 0;
+		while(input.size() - position >= sizeof(unsigned int))
+		{
+			unsigned int length;
+			memcpy(&length, input.data() + position, sizeof(length));
+			if(input.size() - position - sizeof(length) < length)
+				break;
+			frameReader reader(input.data() + position + sizeof(length), length);
+			unsigned int requestId;
+			int status;
+			if(!reader.readNumber(requestId) || !reader.readNumber(status) || requestId >= static_cast<unsigned int>(sent))
+			{
+				success = -1;
+				break;
+			}
+			if(status == STATUS_BAD_REQUEST)
+				++badRequests;
+			latency[requestId] = receiveTime - sentAt[requestId];
+			++received;
+			position += sizeof(length) + length;
+		}
+		input.erase(0, position);
+	}
+	double elapsed = now() - start;
+	close(fd);
+
+	if(success < 0)
+		cout << "Error- connection to server failed after " << received << " responses" << endl;
+	else
+	{
+		sort(latency, latency + numRequests);
+		printf("%d requests, pipeline depth %d, %.3f s\n", numRequests, pipelineDepth, elapsed);
+		printf("Throughput: %.0f requests/s\n", numRequests / elapsed);
+		printf("Latency: p50 %.1f us, p99 %.1f us, max %.1f us\n", latency[numRequests / 2] * 1e6,
+		       latency[static_cast<int>(numRequests * 0.99)] * 1e6, latency[numRequests - 1] * 1e6);
+		if(badRequests)
+			printf("Error- the server rejected %d requests\n", badRequests);
+	}
+	delete [] sentAt;
+	delete [] latency;
+	return success;
+}
@@ -0,0 +1,104 @@
+/* server.h
+ *
+ * The purpose of this file is to hold the class interfaces and function prototypes for the catalog server, which
+ * lets several processes share one list of snow activities. The server holds a single activityList and answers
+ * requests sent to it over a Unix domain socket, using a compact binary protocol. It uses epoll to serve many
+ * connections from one thread without blocking, and clients may pipeline requests- send many requests without
+ * waiting for the responses to the earlier ones. The server handles every complete request it has received from a
+ * connection at once, and sends all of their responses back together. This file also holds the load generator client,
+ * which measures the throughput and latency of a running server.
+ *
+ * Every message is a frame: a 4 byte length (the number of bytes in the rest of the frame), followed by a 4 byte
+ * request id chosen by the client. A request then holds a 1 byte opcode followed by the fields for that opcode, and
+ * the response to it holds the same request id, a 4 byte status (the return value of the activityList function that
+ * handled the request), and a text payload. Numbers are sent in the byte order of the machine, since both ends of a
+ * Unix domain socket are on the same machine. Strings are sent as a 2 byte length followed by their characters, and
+ * the payload as a 4 byte length followed by its characters.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "snow.h"
+#include <string>
+
+using namespace std;
+
+// The requests the server understands, and the fields that follow each opcode in a request
+enum serverOpcode
+{
+	OP_ADD_ACTIVITY = 1, // name, description, equipment, cost (float)
+	OP_REMOVE_ACTIVITY = 2, // name
+	OP_LOOKUP = 3, // name- the payload holds the activity and its locations, as written by writeToFile
+	OP_ADD_LOCATION = 4, // activity name, location name, description, reservation, parking spots (int)
+	OP_RESERVATION = 5, // activity name, location name- the payload holds the reservation requirements
+	OP_PAGE = 6, // first rank (int), number of activities (int)- the payload holds the activities, as displayed
+	OP_COUNT = 7, // no fields- the status holds the number of activities
+	OP_RANK = 8 // name- the status holds the rank of the activity, or -1
+};
+
+// The status sent back when a request could not be decoded or has an unknown opcode
+const int STATUS_BAD_REQUEST = -100;
+// The largest frame the server will accept, to guard against a client sending a nonsense length
+const unsigned int SERVER_MAX_FRAME = 1 << 20;
+// Once this many bytes of responses are waiting to be sent on a connection, the server stops handling and reading
+// new requests from it until the client catches up
+const size_t SERVER_MAX_PENDING = 4 << 20;
+// The most bytes of requests kept for a connection before the server stops reading from it, which is enough to hold
+// the largest frame along with its length
+const size_t SERVER_MAX_INPUT = 2 * SERVER_MAX_FRAME;
+// The most activities a single page request can ask for
+const int SERVER_MAX_PAGE = 1000;
+
+// This struct will hold the state of one client connection to the server: the bytes received that have not been
+// handled yet, and the bytes of responses that have not been sent yet.
+struct serverConnection
+{
+	int fd; // The socket for this connection
+	string input; // Bytes received from the client that have not been handled yet
+	string output; // Bytes of responses waiting to be sent to the client
+	size_t outputSent; // The number of bytes at the front of output that have already been sent
+	unsigned int events; // The events epoll is watching this connection for
+	bool peerClosed; // Whether the client has finished sending- the connection closes once output is sent
+	serverConnection * previous; // Pointer to the previous connection in the list of open connections
+	serverConnection * next; // Pointer to the next connection in the list of open connections
+};
+
+// This class will serve a list of activities over a Unix domain socket. The run function listens on the socket and
+// handles requests until the server is interrupted (by SIGINT or SIGTERM).
+class catalogServer
+{
+	public:
+		// Constructor: serve the activities in this list
+		catalogServer(activityList & passedList);
+		// Destructor: close any connections that are still open
+		~catalogServer();
+		// Listen on the socket at this path, and handle requests until interrupted
+		int run(char * socketPath);
+
+	private:
+		activityList & myList; // The list of activities being served
+		int epollFd; // The epoll instance watching the listening socket and the connections
+		serverConnection * connections; // Pointer to the first connection in the list of open connections
+		// Accept every connection waiting on the listening socket
+		int acceptAll(int listenFd);
+		// Read everything available from a connection, up to the most bytes of requests it may hold
+		int readAll(serverConnection * connection);
+		// Handle each complete request received on a connection, until too many responses are waiting
+		int handleAll(serverConnection * connection);
+		// Send as much of the waiting responses as the connection will take
+		int writeAll(serverConnection * connection);
+		// Close a connection and release it
+		void closeConnection(serverConnection * connection);
+		// Handle one request, and add the response to the connection's output
+		void handleRequest(const char * frame, int length, string & output);
+		// Update the events epoll watches a connection for, closing it if it is finished
+		int updateInterest(serverConnection * connection);
+};
+
+// Run a catalog server for a list of activities on the socket at this path
+int runServer(activityList & myList, char * socketPath);
+// Run the load generator against the server on the socket at this path, and report throughput and latency
+int runLoadClient(char * socketPath, int numRequests, int pipelineDepth);
+
+#endif
@@ -0,0 +1,381 @@
+/* shard.cpp
+ *
+ * The purpose of this file is to hold the source code for the sharded version of our snow activities ADT, and the
+ * pool of threads it uses to work on every shard at once.
+ */
+
+#include "shard.h"
+#include <sstream>
+using namespace std;
+
+// The number of activities each thread renders at a time when displaying or exporting the whole list
+const int MERGE_BATCH_PER_THREAD = 256;
+
+/******************** shardPool Class: *******************************************/
+
+// This function serves as the constructor for the shardPool class, and starts the worker threads. At least one
+// worker is always started.
+shardPool::shardPool(int passedNumThreads)
+{
+	numThreads = passedNumThreads < 1 ? 1 : passedNumThreads;
+	task = nullptr;
+	next = count = remaining = 0;
+	stopping = false;
+	workers = new thread[numThreads];
+	for(int i = 0; i < numThreads; ++i)
+		workers[i] = thread(&shardPool::work, this);
+}
+
+// This function serves as the destructor for the shardPool class. It tells the workers to stop, and waits for each
+// of them to exit before releasing them.
+shardPool::~shardPool()
+{
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for(int i = 0; i < numThreads; ++i)
+		workers[i].join();
+	delete [] workers;
+}
+
+// This function will call the task passed in once for each number from 0 to passedCount - 1, spread across the
+// worker threads, and will wait until every call has finished. Returns the number of calls made.
+int shardPool::run(int passedCount, const function<void(int)> & passedTask)
+{
+	if(passedCount <= 0)
+		return 0;
+	lock_guard<mutex> running(runLock);
+	unique_lock<mutex> guard(lock);
+	task = &passedTask;
+	next = 0;
+	count = remaining = passedCount;
+	wake.notify_all();
+	done.wait(guard, [this] { return remaining == 0; });
+	task = nullptr;
+	return passedCount;
+}
+
+// This function is the loop run by each worker thread. The worker sleeps until there are numbers left to hand out,
+// then takes them one at a time and calls the task with each, until none are left. The last worker to finish a call
+// wakes up the run function.
+void shardPool::work()
+{
+	unique_lock<mutex> guard(lock);
+	while(true)
+	{
+		wake.wait(guard, [this] { return stopping || next < count; });
+		if(stopping)
+			return;
+		while(next < count)
+		{
+			int i = next++;
+			const function<void(int)> * current = task;
+			// Let the other workers take numbers while we work on this one
+			guard.unlock();
+			(*current)(i);
+			guard.lock();
+			if(--remaining == 0)
+				done.notify_one();
+		}
+	}
+}
+
+int shardPool::getNumThreads()
+{
+	return numThreads;
+}
+
+/******************** shardedActivityList Class: *********************************/
+
+// This function serves as the constructor for the shardedActivityList class. It creates the shards (at least one),
+// a lock for each shard, and the pool of threads used to scan them.
+shardedActivityList::shardedActivityList(int passedNumShards, int numThreads) : pool(numThreads)
+{
+	numShards = passedNumShards < 1 ? 1 : passedNumShards;
+	shards = new activityList[numShards];
+	locks = new mutex[numShards];
+}
+
+// This function serves as the destructor for the shardedActivityList class. Each shard releases its own activities.
+shardedActivityList::~shardedActivityList()
+{
+	delete [] shards;
+	delete [] locks;
+}
+
+// These functions pick the shard an activity belongs in from the hash of its name, folded under the collation the
+// shards are ordered by. An activity passed in as an activityData object and one passed in by name always end up in
+// the same shard, as do names that only differ in ways the collation ignores.
+int shardedActivityList::shardOf(activityData & passedActivity)
+{
+	passedActivity.setCollation(shards[0].getCollation());
+	return passedActivity.hashName() % numShards;
+}
+
+int shardedActivityList::shardOf(char * activityName)
+{
+	return hashName(activityName, shards[0].getCollation()) % numShards;
+}
+
+// The functions below each work on a single activity, so they lock and call the matching activityList function on
+// the one shard the activity belongs in, and return whatever that function returns.
+int shardedActivityList::addActivity(activityData & newActivity)
+{
+	int shard = shardOf(newActivity);
+	lock_guard<mutex> guard(locks[shard]);
+	return shards[shard].addActivity(newActivity);
+}
+
+bool shardedActivityList::checkMatch(activityData & passedActivity)
+{
+	int shard = shardOf(passedActivity);
+	lock_guard<mutex> guard(locks[shard]);
+	return shards[shard].checkMatch(passedActivity);
+}
+
+int shardedActivityList::addLocation(char * activityName, char * locationName, char passedDescription[], char passedReservation[], int numSpots)
+{
+	int shard = shardOf(activityName);
+	lock_guard<mutex> guard(locks[shard]);
+	return shards[shard].addLocation(activityName, locationName, passedDescription, passedReservation, numSpots);
+}
+
+int shardedActivityList::displayLocations(char * activityName)
+{
+	int shard = shardOf(activityName);
+	lock_guard<mutex> guard(locks[shard]);
+	return shards[shard].displayLocations(activityName);
+}
+
+int shardedActivityList::displayReservation(char * activityName, char * locationName)
+{
+	int shard = shardOf(activityName);
+	lock_guard<mutex> guard(locks[shard]);
+	return shards[shard].displayReservation(activityName, locationName);
+}
+
+int shardedActivityList::removeActivity(char * activityName)
+{
+	int shard = shardOf(activityName);
+	lock_guard<mutex> guard(locks[shard]);
+	// An empty shard does not mean the whole list is empty, so report it as no matching activity found
+	int success = shards[shard].removeActivity(activityName);
+	return success ? success : -1;
+}
+
+// This function will add up the number of activities in each shard. Each shard keeps its own count, so this only
+// needs to hold the lock for each shard for a moment.
+int shardedActivityList::getCount()
+{
+	int total = 0;
+	for(int i = 0; i < numShards; ++i)
+	{
+		lock_guard<mutex> guard(locks[i]);
+		total += shards[i].getCount();
+	}
+	return total;
+}
+
+int shardedActivityList::getNumShards()
+{
+	return numShards;
+}
+
+// This function will count the locations in the whole list whose reservation policy and parking match a filter, the
+// same way as the countLocations function of the activityList class. Every shard is locked first, and then each shard
+// scans its own location table on the pool of threads. The counts are added up once every shard has finished.
+int shardedActivityList::countLocations(unsigned char policyMask, unsigned char policyValue, int minSpots)
+{
+	int * counts = new int[numShards];
+	lockAll();
+	pool.run(numShards, [&](int shard)
+	{
+		counts[shard] = shards[shard].countLocations(policyMask, policyValue, minSpots);
+	});
+	unlockAll();
+	int total = 0;
+	for(int i = 0; i < numShards; ++i)
+		total += counts[i];
+	delete [] counts;
+	return total;
+}
+
+// This function will summarize the whole list, the same way as the getSummary function of the activityList class.
+// Every shard is locked first, and then each shard fills in its own summary on the pool of threads. The summaries are
+// combined once every shard has finished: the counts and totals are added up, the cheapest and most expensive costs
+// are the cheapest and most expensive of any shard, and the average is weighted by the number of activities in each
+// shard. Returns 0 if the list is empty, or 1 otherwise.
+int shardedActivityList::getSummary(catalogSummary & summary)
+{
+	catalogSummary * parts = new catalogSummary[numShards];
+	lockAll();
+	pool.run(numShards, [&](int shard)
+	{
+		shards[shard].getSummary(parts[shard]);
+	});
+	unlockAll();
+	summary.numActivities = summary.numLocations = 0;
+	summary.totalParking = 0;
+	summary.minCost = summary.maxCost = summary.averageCost = 0;
+	for(int i = 0; i < COST_BUCKETS; ++i)
+		summary.costHistogram[i] = 0;
+	double totalCost = 0;
+	for(int shard = 0; shard < numShards; ++shard)
+	{
+		catalogSummary & part = parts[shard];
+		if(part.numActivities)
+		{
+			if(!summary.numActivities || part.minCost < summary.minCost)
+				summary.minCost = part.minCost;
+			if(!summary.numActivities || part.maxCost > summary.maxCost)
+				summary.maxCost = part.maxCost;
+			totalCost += static_cast<double>(part.averageCost) * part.numActivities;
+		}
+		summary.numActivities += part.numActivities;
+		summary.numLocations += part.numLocations;
+		summary.totalParking += part.totalParking;
+		for(int i = 0; i < COST_BUCKETS; ++i)
+			summary.costHistogram[i] += part.costHistogram[i];
+	}
+	if(summary.numActivities)
+		summary.averageCost = totalCost / summary.numActivities;
+	delete [] parts;
+	return summary.numActivities ? 1 : 0;
+}
+
+// This function will display all of the activities in alphabetical order, the same way as the displayAll function
+// of the activityList class. Returns 0 if the list is empty, or 1 on success.
+int shardedActivityList::displayAll()
+{
+	if(!getCount())
+		return 0;
+	return mergeAll(cout, false);
+}
+
+// This function will write all of the activities to a file, in the same format and order as the writeToFile function
+// of the activityList class. Returns -1 if the file could not be opened or written to, or 1 on success.
+int shardedActivityList::writeToFile(char * fileName)
+{
+	ofstream outFile(fileName);
+	if(!outFile)
+		return -1;
+	return writeToStream(outFile);
+}
+
+int shardedActivityList::writeToStream(ostream & out)
+{
+	return mergeAll(out, true);
+}
+
+// This function will restore the order of a min-heap of shards, ordered by the next activity in each shard, by moving
+// the shard at position start down past any shard whose next activity comes before its own.
+static void siftDown(activityNode ** current, int * heap, int size, int start)
+{
+	int shard = heap[start];
+	while(2 * start + 1 < size)
+	{
+		int child = 2 * start + 1;
+		if(child + 1 < size && current[heap[child + 1]] -> activity.compareName(current[heap[child]] -> activity) < 0)
+			++child;
+		if(current[shard] -> activity.compareName(current[heap[child]] -> activity) <= 0)
+			break;
+		heap[start] = heap[child];
+		start = child;
+	}
+	heap[start] = shard;
+}
+
+// This function does the work of displaying or exporting the whole list. Every shard is locked first, by lockAll. The
+// activities are then handled in batches: the next batch of activities is taken from the shards in alphabetical
+// order, much like merging sorted piles of cards. The shards that still have
+// activities left are kept in a min-heap ordered by their next activity, so taking each activity only costs a few
+// comparisons, rather than one for every shard. The batch is split evenly across the pool of threads, each of which
+// renders its part to text, and the parts are written out in order. Rendering is the slow part of the work, so it is
+// done in parallel, while the buffers each thread renders into are reused from batch to batch so they stay small.
+// Returns -1 if the stream could not be written to, or 1 on success.
+int shardedActivityList::mergeAll(ostream & out, bool forFile)
+{
+	lockAll();
+
+	int numParts = pool.getNumThreads();
+	int batchSize = numParts * MERGE_BATCH_PER_THREAD;
+	activityNode ** current = new activityNode * [numShards];
+	int * shardOfNode = new int[batchSize];
+	activityNode ** batch = new activityNode * [batchSize];
+	stringstream * rendered = new stringstream[numParts];
+	int * heap = new int[numShards];
+	int heapSize = 0;
+	for(int i = 0; i < numShards; ++i)
+	{
+		current[i] = shards[i].head;
+		if(current[i])
+			heap[heapSize++] = i;
+	}
+	for(int i = heapSize / 2 - 1; i >= 0; --i)
+		siftDown(current, heap, heapSize, i);
+
+	int success = 1;
+	int numInBatch;
+	do
+	{
+		// Take the next batch of activities from the shards in alphabetical order
+		for(numInBatch = 0; numInBatch < batchSize && heapSize; ++numInBatch)
+		{
+			int first = heap[0];
+			batch[numInBatch] = current[first];
+			shardOfNode[numInBatch] = first;
+			current[first] = current[first] -> next;
+			// A shard with no activities left leaves the heap
+			if(!current[first])
+				heap[0] = heap[--heapSize];
+			if(heapSize)
+				siftDown(current, heap, heapSize, 0);
+		}
+
+		// Render each part of the batch in parallel, then write the parts out in order
+		pool.run(numParts, [&](int part)
+		{
+			rendered[part].str("");
+			int end = numInBatch * (part + 1) / numParts;
+			for(int i = numInBatch * part / numParts; i < end; ++i)
+			{
+				if(forFile)
+					shards[shardOfNode[i]].writeActivity(batch[i], rendered[part]);
+				else
+					batch[i] -> activity.display(rendered[part]);
+			}
+		});
+		// Inserting an empty buffer would mark the stream as failed, so skip parts with nothing rendered
+		for(int part = 0; part < numParts; ++part)
+			if(rendered[part].tellp() > 0)
+				out << rendered[part].rdbuf();
+		if(!out)
+			success = -1;
+	} while(success > 0 && numInBatch == batchSize);
+
+	delete [] current;
+	delete [] heap;
+	delete [] shardOfNode;
+	delete [] batch;
+	delete [] rendered;
+	unlockAll();
+	return success;
+}
+
+// This function will lock every shard, always in the same order, so that two threads working on the whole list cannot
+// each hold a shard the other is waiting for. It must be called before handing work on the whole list to the pool of
+// threads, whose tasks never lock a shard themselves: a thread waiting for the pool never holds some shards while
+// another thread holding the pool waits for them.
+void shardedActivityList::lockAll()
+{
+	for(int i = 0; i < numShards; ++i)
+		locks[i].lock();
+}
+
+void shardedActivityList::unlockAll()
+{
+	for(int i = numShards - 1; i >= 0; --i)
+		locks[i].unlock();
+}
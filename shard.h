@@ -0,0 +1,113 @@
+/* shard.h
+ *
+ * The purpose of this file is to hold the class interfaces for a sharded version of our snow activities ADT. A single
+ * activityList keeps every activity in one chain behind one head pointer, so every operation on the list has to wait
+ * its turn. The shardedActivityList class splits the activities across several independent activityList shards,
+ * chosen by a hash of the name of the activity. Operations on a single activity only need to visit (and lock) the one
+ * shard it belongs to, while operations on the whole list are run on every shard at once by a pool of threads, and
+ * their results are merged back together in alphabetical order.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "snow.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <string>
+
+using namespace std;
+
+// This class will manage a fixed pool of worker threads. The run function hands out the numbers 0 to count - 1 to
+// the workers, each of which calls the task with the numbers it is given, and returns once all of them are done.
+// Starting the threads once and reusing them avoids paying to create a thread every time the list is scanned.
+class shardPool
+{
+	public:
+		// Constructor: start the worker threads
+		shardPool(int passedNumThreads);
+		// Destructor: stop and join the worker threads
+		~shardPool();
+		// Call task(i) for each i from 0 to count - 1 across the workers, and wait for all of the calls to finish
+		int run(int count, const function<void(int)> & task);
+		// The number of worker threads in the pool
+		int getNumThreads();
+
+	private:
+		thread * workers; // The worker threads
+		int numThreads; // The number of worker threads
+		mutex runLock; // Held for the length of a run, so only one run is handed out at a time
+		mutex lock; // Protects all of the data below
+		condition_variable wake; // Signaled when a new run starts, or the pool is stopping
+		condition_variable done; // Signaled when the last task of a run finishes
+		const function<void(int)> * task; // The task for the current run
+		int next; // The next number to hand out in the current run
+		int count; // The number of calls in the current run
+		int remaining; // The number of calls in the current run that have not finished yet
+		bool stopping; // Whether the workers should exit
+		// The loop run by each worker thread
+		void work();
+};
+
+// This class will manage a list of snow activities split across several activityList shards. Each activity is kept
+// in the shard picked by the hash of its name, so the shards share the work of the list evenly. Every shard has its
+// own lock, so operations on activities in different shards can happen at the same time from different threads.
+// Displaying or exporting the whole list merges the shards in alphabetical order and renders the activities in
+// parallel using the pool of threads, so the output is the same as that of a single activityList. Counting locations
+// and summarizing the list ask every shard at once on the pool, and combine their answers. Work on the whole list
+// always locks every shard on the calling thread before using the pool, and the tasks run by the pool never take a
+// shard lock themselves, so two scans of the whole list cannot each hold a lock the other is waiting for.
+class shardedActivityList
+{
+	public:
+		// Constructor: create the shards, and a pool of threads to scan them with
+		shardedActivityList(int passedNumShards, int numThreads);
+		// Destructor: release the shards
+		~shardedActivityList();
+		// Add a new activity to the shard it belongs in
+		int addActivity(activityData & newActivity);
+		// Check if the name of an activity matches any of the activities in the list
+		bool checkMatch(activityData & passedActivity);
+		// Add a location to an activity with this name
+		int addLocation(char * activityName, char * locationName, char passedDescription[], char passedReservation[], int numSpots);
+		// Display all of the locations associated with an activity with this name
+		int displayLocations(char * activityName);
+		// Display the reservation requirements for this activity at this location
+		int displayReservation(char * activityName, char * locationName);
+		// Remove an activity with this name from the list
+		int removeActivity(char * activityName);
+		// The number of activities in all of the shards
+		int getCount();
+		// Display all of the activities in alphabetical order
+		int displayAll();
+		// Write all of the activities to a file in alphabetical order, in the same format as activityList
+		int writeToFile(char * fileName);
+		// Write all of the activities to a stream in alphabetical order, in the same format as activityList
+		int writeToStream(ostream & out);
+		// The number of shards the activities are split across
+		int getNumShards();
+		// Count the locations in every shard whose reservation policy and parking match a filter
+		int countLocations(unsigned char policyMask, unsigned char policyValue, int minSpots);
+		// Summarize the activities in every shard
+		int getSummary(catalogSummary & summary);
+
+	private:
+		activityList * shards; // The shards holding the activities
+		mutex * locks; // One lock for each shard
+		int numShards; // The number of shards
+		shardPool pool; // The threads used to scan all of the shards at once
+		// Find the shard an activity belongs in
+		int shardOf(activityData & passedActivity);
+		// Find the shard an activity with this name belongs in
+		int shardOf(char * activityName);
+		// Render every shard in parallel, then merge the rendered activities to a stream in alphabetical order
+		int mergeAll(ostream & out, bool forFile);
+		// Lock every shard, in order, before handing work on the whole list to the pool
+		void lockAll();
+		// Unlock every shard locked by lockAll
+		void unlockAll();
+};
+
+#endif
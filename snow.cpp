@@ -4,8 +4,718 @@
  */
 
 #include "snow.h"
+#include <cstdio>
+#include <cmath>
+#include <map>
+#include <string>
 using namespace std;
 
+// Snapshot files begin with these four characters, followed by the version of the snapshot format
+const char SNAPSHOT_MAGIC[] = "SNOW";
+const int SNAPSHOT_VERSION = 3;
+// Version 1 snapshots stored the reservation requirements of each location as text, rather than as a policy
+const int SNAPSHOT_TEXT_RESERVATIONS = 1;
+// Snapshots up to version 2 did not record a collation, and their activities are always in binary order
+const int SNAPSHOT_BINARY_COLLATION = 2;
+// The number of bytes of each sort key packed into its key prefix
+const int KEY_PREFIX_BYTES = 8;
+// The size of the buffer the activity index folds a name into when searching for it- longer names are folded into
+// memory allocated for the search instead
+const int PROBE_KEY_SIZE = 256;
+// The number of names stored in each block of the front-coded name index written to snapshots
+const int NAME_BLOCK_SIZE = 16;
+// The size of a buffer large enough to hold the standard text for any reservation policy
+const int RESERVATION_TEXT_SIZE = 128;
+// The most levels an index node can have- enough for the index to stay fast with millions of activities
+const int INDEX_MAX_LEVEL = 24;
+// The longest string we will accept when reading a snapshot, to guard against corrupt files
+const int SNAPSHOT_MAX_STRING = 1 << 20;
+
+// Patch files begin with these four characters, followed by the version of the patch format
+const char PATCH_MAGIC[] = "SNWP";
+const int PATCH_VERSION = 1;
+// Each change in a patch begins with one of these bytes, and the patch ends with PATCH_END and the number of changes
+const int PATCH_END = 0;
+const int PATCH_ADD_ACTIVITY = 1; // name, record, locations- add an activity along with its locations
+const int PATCH_REMOVE_ACTIVITY = 2; // name- remove an activity along with its locations
+const int PATCH_UPDATE_ACTIVITY = 3; // name, record- replace the description, equipment and cost of an activity
+const int PATCH_UPDATE_LOCATIONS = 4; // name, number to remove, locations- replace the first locations of an activity
+
+// Helper functions for reading and writing binary snapshot files. Integers are written in the byte order of the
+// machine, and strings are written as their length followed by their characters (without the terminating null).
+static int writeInt(ofstream & outFile, int value)
+{
+	outFile.write(reinterpret_cast<char *>(&value), sizeof(value));
+	return outFile ? 1 : 0;
+}
+
+static int readInt(ifstream & inFile, int & value)
+{
+	inFile.read(reinterpret_cast<char *>(&value), sizeof(value));
+	return inFile ? 1 : 0;
+}
+
+static int writeString(ofstream & outFile, char * text)
+{
+	int length = strlen(text);
+	if(!writeInt(outFile, length))
+		return 0;
+	outFile.write(text, length);
+	return outFile ? 1 : 0;
+}
+
+// Reads a string written by writeString into a newly allocated char array. Returns null if the string could not be
+// read- otherwise, the caller is responsible for deallocating the array.
+static char * readString(ifstream & inFile)
+{
+	int length;
+	if(!readInt(inFile, length) || length < 0 || length > SNAPSHOT_MAX_STRING)
+		return nullptr;
+	char * text = new char[length + 1];
+	inFile.read(text, length);
+	if(!inFile)
+	{
+		delete [] text;
+		return nullptr;
+	}
+	text[length] = '\0';
+	return text;
+}
+
+// Writes the first count locations in a list of locations to a binary snapshot or patch file, preceded by the count.
+// Each location is written as its name and description, its reservation policy, whether there is reservation detail
+// (followed by the detail if there is), and its number of parking spots.
+static int writeLocations(ofstream & outFile, locationNode * location, int count)
+{
+	writeInt(outFile, count);
+	for(int i = 0; location && i < count; ++i, location = location -> next)
+	{
+		writeString(outFile, location -> name);
+		writeString(outFile, location -> description);
+		outFile.put(location -> reservationPolicy);
+		outFile.put(location -> reservationDetail ? 1 : 0);
+		if(location -> reservationDetail)
+			writeString(outFile, location -> reservationDetail);
+		writeInt(outFile, location -> numParkingSpots);
+	}
+	return outFile ? 1 : 0;
+}
+
+// Releases a chain of locations that is not part of any activityList.
+static void releaseChain(locationNode * location)
+{
+	while(location)
+	{
+		locationNode * temp = location -> next;
+		delete [] location -> name;
+		delete [] location -> description;
+		delete [] location -> reservationDetail;
+		delete location;
+		location = temp;
+	}
+}
+
+// Releases an activity node that is not part of any activityList, along with its locations.
+static void releaseDetached(activityNode * node)
+{
+	if(!node)
+		return;
+	releaseChain(node -> head);
+	delete node;
+}
+
+// Reads a location written by writeLocations into a new location node that is not part of any list. Version 1
+// snapshots held the reservation requirements as text, so those are parsed into a policy, and the text is only kept
+// if it says more than the policy does. Returns null if the location could not be read.
+static locationNode * readLocation(ifstream & inFile, int version)
+{
+	char * locationName = readString(inFile);
+	char * locationDescription = readString(inFile);
+	char * detail = nullptr;
+	unsigned char policy = RESERVATION_UNKNOWN;
+	int numSpots = 0;
+	bool valid = locationName && locationDescription;
+	if(valid && version == SNAPSHOT_TEXT_RESERVATIONS)
+	{
+		detail = readString(inFile);
+		if(detail)
+		{
+			policy = parseReservation(detail);
+			char standardText[RESERVATION_TEXT_SIZE];
+			formatReservation(policy, standardText, RESERVATION_TEXT_SIZE);
+			if(strcmp(standardText, detail) == 0)
+			{
+				delete [] detail;
+				detail = nullptr;
+			}
+		}
+		else
+			valid = false;
+	}
+	else if(valid)
+	{
+		policy = inFile.get();
+		if(inFile.get() == 1)
+		{
+			detail = readString(inFile);
+			if(!detail)
+				valid = false;
+		}
+	}
+	if(!valid || !readInt(inFile, numSpots))
+	{
+		delete [] locationName;
+		delete [] locationDescription;
+		delete [] detail;
+		return nullptr;
+	}
+	locationNode * location = new locationNode;
+	location -> name = locationName;
+	location -> description = locationDescription;
+	location -> reservationDetail = detail;
+	location -> reservationPolicy = policy;
+	location -> numParkingSpots = numSpots;
+	location -> slot = -1;
+	location -> next = nullptr;
+	return location;
+}
+
+// Reads a count followed by that many locations, written by writeLocations, into a chain of new location nodes in
+// the same order. Returns 1 on success, or 0 if the locations could not be read (in which case the chain is null).
+static int readLocations(ifstream & inFile, int version, locationNode * & chain)
+{
+	chain = nullptr;
+	int count;
+	if(!readInt(inFile, count) || count < 0)
+		return 0;
+	locationNode * tail = nullptr;
+	for(int i = 0; i < count; ++i)
+	{
+		locationNode * location = readLocation(inFile, version);
+		if(!location)
+		{
+			releaseChain(chain);
+			chain = nullptr;
+			return 0;
+		}
+		if(tail)
+			tail -> next = location;
+		else
+			chain = location;
+		tail = location;
+	}
+	return 1;
+}
+
+// Reads the description, equipment and cost of an activity, written by the writeRecord function of the activityData
+// class, and loads them into the passed activity along with the passed name. Returns 1 on success, or 0 if the record
+// could not be read.
+static int readRecord(ifstream & inFile, char * name, activityData & activity)
+{
+	char * description = readString(inFile);
+	char * equipment = readString(inFile);
+	float cost = 0.0;
+	int success = 0;
+	if(description && equipment)
+	{
+		inFile.read(reinterpret_cast<char *>(&cost), sizeof(cost));
+		if(inFile)
+			success = activity.loadActivity(name, description, equipment, cost);
+	}
+	delete [] description;
+	delete [] equipment;
+	return success;
+}
+
+// Reads the record of an activity followed by its locations into a new activity node, keyed under the passed
+// collation, that is not part of any list. Returns null if the activity could not be read.
+static activityNode * readActivity(ifstream & inFile, char * name, int collation, int version)
+{
+	activityNode * temp = new activityNode;
+	temp -> head = nullptr;
+	temp -> next = nullptr;
+	temp -> numLocations = 0;
+	temp -> totalParking = 0;
+	temp -> activity.setCollation(collation);
+	if(!readRecord(inFile, name, temp -> activity) || !readLocations(inFile, version, temp -> head))
+	{
+		releaseDetached(temp);
+		return nullptr;
+	}
+	return temp;
+}
+
+/******************** nameBlockIndex Class: *****************************************/
+
+// This function will serve as the default constructor of the nameBlockIndex class. The constructor will set the
+// index to empty, with the default number of names per block.
+nameBlockIndex::nameBlockIndex()
+{
+	bytes = nullptr;
+	byteCount = byteCapacity = 0;
+	blockOffsets = nullptr;
+	blockCount = blockCapacity = 0;
+	blockSize = NAME_BLOCK_SIZE;
+	count = longest = 0;
+	lastName = scratch = nullptr;
+	nameCapacity = 0;
+	collation = DEFAULT_COLLATION;
+}
+
+// This function is the destructor for the nameBlockIndex class, and will release all of the dynamic memory used
+// to hold the names.
+nameBlockIndex::~nameBlockIndex()
+{
+	reset(blockSize);
+}
+
+// This function will release all of the names held in the index, and set the number of names that will be stored
+// in each block. Smaller blocks make lookups faster, while larger blocks share more prefixes and save more memory.
+// The function returns 0 if the block size is less than one, or 1 on success.
+int nameBlockIndex::reset(int passedBlockSize)
+{
+	if(passedBlockSize < 1)
+		return 0;
+	delete [] bytes;
+	delete [] blockOffsets;
+	delete [] lastName;
+	delete [] scratch;
+	bytes = nullptr;
+	byteCount = byteCapacity = 0;
+	blockOffsets = nullptr;
+	blockCount = blockCapacity = 0;
+	blockSize = passedBlockSize;
+	count = longest = 0;
+	lastName = scratch = nullptr;
+	nameCapacity = 0;
+	return 1;
+}
+
+// This function will set the collation the names in the index are sorted by, which the find function needs to know
+// to search for a name. Returns 0 if the collation is not valid, or 1 on success.
+int nameBlockIndex::setCollation(int mode)
+{
+	if(mode < COLLATE_BINARY || mode > COLLATE_ACCENTS)
+		return 0;
+	collation = mode;
+	return 1;
+}
+
+// This function will make sure there is room for at least needed more bytes of names, doubling the size of the
+// array of bytes when it must grow.
+int nameBlockIndex::reserveBytes(int needed)
+{
+	if(byteCount + needed <= byteCapacity)
+		return 1;
+	int newCapacity = byteCapacity ? byteCapacity * 2 : 256;
+	while(newCapacity < byteCount + needed)
+		newCapacity *= 2;
+	char * newBytes = new char[newCapacity];
+	if(bytes)
+		memcpy(newBytes, bytes, byteCount);
+	delete [] bytes;
+	bytes = newBytes;
+	byteCapacity = newCapacity;
+	return 1;
+}
+
+// This function will make sure that lastName and scratch can both hold a name of the passed length. The contents
+// of lastName are kept when the buffers grow.
+int nameBlockIndex::reserveNames(int length)
+{
+	if(length < nameCapacity)
+		return 1;
+	char * newLastName = new char[length + 1];
+	if(lastName)
+		strcpy(newLastName, lastName);
+	else
+		newLastName[0] = '\0';
+	delete [] lastName;
+	delete [] scratch;
+	lastName = newLastName;
+	scratch = new char[length + 1];
+	nameCapacity = length + 1;
+	return 1;
+}
+
+// This function will append a name to the end of the index. The names must be appended in the same order as the
+// list they are taken from, since each name is stored relative to the one before it. If the name starts a new block
+// it is stored in full- otherwise, only the length of the prefix it shares with the previous name (up to 255 chars)
+// and the remaining characters are stored. Returns 1 on success, or 0 if a null name is passed in.
+int nameBlockIndex::addName(char * passedName)
+{
+	if(!passedName)
+		return 0;
+	int length = strlen(passedName);
+	bool isHead = count % blockSize == 0;
+	int shared = 0;
+	// Count the characters this name shares with the last name appended
+	if(!isHead)
+		while(shared < 255 && lastName[shared] && lastName[shared] == passedName[shared])
+			++shared;
+
+	reserveBytes((isHead ? 0 : 1) + length - shared + 1);
+	if(isHead)
+	{
+		// Record where the new block begins
+		if(blockCount == blockCapacity)
+		{
+			int newCapacity = blockCapacity ? blockCapacity * 2 : 16;
+			int * newOffsets = new int[newCapacity];
+			if(blockOffsets)
+				memcpy(newOffsets, blockOffsets, blockCount * sizeof(int));
+			delete [] blockOffsets;
+			blockOffsets = newOffsets;
+			blockCapacity = newCapacity;
+		}
+		blockOffsets[blockCount++] = byteCount;
+	}
+	else
+		bytes[byteCount++] = static_cast<char>(shared);
+	memcpy(bytes + byteCount, passedName + shared, length - shared + 1);
+	byteCount += length - shared + 1;
+
+	// Hold onto this name so that the next name can be stored relative to it
+	reserveNames(length);
+	strcpy(lastName, passedName);
+	if(length > longest)
+		longest = length;
+	++count;
+	return 1;
+}
+
+// This function will decode the name at a position in the index into the buffer passed in, which must be able to
+// hold the longest name in the index. The head of the block is copied in full, then each name after it overwrites
+// the buffer past the prefix it shares with the name before it, until we reach the position we are looking for.
+void nameBlockIndex::decode(int position, char buffer[])
+{
+	char * current = bytes + blockOffsets[position / blockSize];
+	strcpy(buffer, current);
+	current += strlen(current) + 1;
+	for(int i = position % blockSize; i > 0; --i)
+	{
+		int shared = static_cast<unsigned char>(*current++);
+		strcpy(buffer + shared, current);
+		current += strlen(current) + 1;
+	}
+}
+
+// This function will find the position of a name in the index. Since the head of each block is stored in full, we
+// can binary search over the block heads for the last block whose head does not come after the name, and then
+// decode the names in that block one at a time. Names are compared under the collation of the index, so a name
+// matches if it differs only in ways the collation ignores. Returns the position of the name, or -1 if it is not
+// found.
+int nameBlockIndex::find(char * passedName)
+{
+	if(!count || !passedName)
+		return -1;
+	int low = 0;
+	int high = blockCount - 1;
+	int block = -1;
+	while(low <= high)
+	{
+		int middle = low + (high - low) / 2;
+		int compare = collateCompare(bytes + blockOffsets[middle], passedName, collation);
+		if(compare == 0)
+			return middle * blockSize;
+		if(compare < 0)
+		{
+			block = middle;
+			low = middle + 1;
+		}
+		else
+			high = middle - 1;
+	}
+	// If the name comes before the first block head, it is not in the index
+	if(block < 0)
+		return -1;
+
+	// Scan through the rest of the block
+	char * current = bytes + blockOffsets[block];
+	strcpy(scratch, current);
+	current += strlen(current) + 1;
+	int position = block * blockSize + 1;
+	int end = position - 1 + blockSize;
+	if(end > count)
+		end = count;
+	for(; position < end; ++position)
+	{
+		int shared = static_cast<unsigned char>(*current++);
+		strcpy(scratch + shared, current);
+		current += strlen(current) + 1;
+		int compare = collateCompare(scratch, passedName, collation);
+		if(compare == 0)
+			return position;
+		// The names are sorted, so once we pass the name it cannot be in the block
+		if(compare > 0)
+			return -1;
+	}
+	return -1;
+}
+
+// This function will copy the name at a position in the index into the buffer passed in. Returns 1 on success, or 0
+// if the position is out of range or the buffer is too small to hold the longest name in the index.
+int nameBlockIndex::getName(int position, char buffer[], int size)
+{
+	if(position < 0 || position >= count || !buffer || size <= longest)
+		return 0;
+	decode(position, buffer);
+	return 1;
+}
+
+int nameBlockIndex::getCount()
+{
+	return count;
+}
+
+int nameBlockIndex::getLongest()
+{
+	return longest;
+}
+
+// This function will write the index to a binary snapshot file, as the block size, number of names, number of
+// blocks, number of bytes and longest name, followed by the block offsets and the front-coded names themselves.
+int nameBlockIndex::write(ofstream & outFile)
+{
+	if(!outFile) return -1;
+	writeInt(outFile, blockSize);
+	writeInt(outFile, count);
+	writeInt(outFile, blockCount);
+	writeInt(outFile, byteCount);
+	writeInt(outFile, longest);
+	if(blockCount)
+		outFile.write(reinterpret_cast<char *>(blockOffsets), blockCount * sizeof(int));
+	if(byteCount)
+		outFile.write(bytes, byteCount);
+	return outFile ? 1 : -1;
+}
+
+// This function will walk the names read into the index in the order decode does, checking that every name decodes
+// within the bytes read and within the longest length, so that decode, find and getName can never read or write past
+// the end of an array. Returns 1 if the names are valid, or 0 otherwise.
+int nameBlockIndex::validate(int passedCount, int passedBlockCount, int passedByteCount, int passedLongest)
+{
+	int position = 0;
+	int previousLength = 0;
+	for(int i = 0; i < passedCount; ++i)
+	{
+		int shared = 0;
+		if(i % blockSize == 0)
+		{
+			// The head of each block is stored in full, and must begin exactly where its offset says
+			if(blockOffsets[i / blockSize] != position)
+				return 0;
+		}
+		else
+		{
+			if(position >= passedByteCount)
+				return 0;
+			shared = static_cast<unsigned char>(bytes[position++]);
+			if(shared > previousLength)
+				return 0;
+		}
+		if(position >= passedByteCount)
+			return 0;
+		char * end = static_cast<char *>(memchr(bytes + position, '\0', passedByteCount - position));
+		if(!end)
+			return 0;
+		int length = shared + static_cast<int>(end - (bytes + position));
+		if(length > passedLongest)
+			return 0;
+		position = end - bytes + 1;
+		previousLength = length;
+	}
+	// Every byte must belong to one of the names, and every block must have been reached
+	return position == passedByteCount && (passedCount - 1) / blockSize == passedBlockCount - 1;
+}
+
+// This function will read an index written by the write function, replacing any names already held in the index.
+// Before the index is used, every block is walked once to make sure the names decode safely: each block must begin
+// exactly where its offset says, each name can only share as many characters as the name before it has, no name can
+// be longer than the longest name, and exactly the number of names in the index must fill the bytes. Returns 1 on
+// success, or 0 if the index could not be read or does not make sense.
+int nameBlockIndex::read(ifstream & inFile)
+{
+	int passedBlockSize, passedCount, passedBlockCount, passedByteCount, passedLongest;
+	if(!readInt(inFile, passedBlockSize) || !readInt(inFile, passedCount) || !readInt(inFile, passedBlockCount)
+	   || !readInt(inFile, passedByteCount) || !readInt(inFile, passedLongest))
+		return 0;
+	if(passedBlockSize < 1 || passedCount < 0 || passedByteCount < 0 || passedLongest < 0
+	   || passedLongest > SNAPSHOT_MAX_STRING
+	   || passedBlockCount != (passedCount + static_cast<long long>(passedBlockSize) - 1) / passedBlockSize
+	   || (passedCount > 0 && passedByteCount == 0))
+		return 0;
+	reset(passedBlockSize);
+	if(!passedCount)
+		return 1;
+
+	blockOffsets = new int[passedBlockCount];
+	blockCapacity = passedBlockCount;
+	bytes = new char[passedByteCount];
+	byteCapacity = passedByteCount;
+	inFile.read(reinterpret_cast<char *>(blockOffsets), passedBlockCount * sizeof(int));
+	inFile.read(bytes, passedByteCount);
+	if(!inFile || bytes[passedByteCount - 1] != '\0')
+	{
+		reset(passedBlockSize);
+		return 0;
+	}
+	if(!validate(passedCount, passedBlockCount, passedByteCount, passedLongest))
+	{
+		reset(passedBlockSize);
+		return 0;
+	}
+	blockCount = passedBlockCount;
+	byteCount = passedByteCount;
+	count = passedCount;
+	longest = passedLongest;
+
+	// Decode the last name so that more names can be appended after it
+	reserveNames(longest);
+	decode(count - 1, lastName);
+	return 1;
+}
+
+// The plain letters each Latin-1 letter from U+00C0 to U+00FF is folded to when accents are ignored, indexed by the
+// second byte of the letter in UTF-8 minus 0x80. Letters like AE and the sharp s fold to two letters, and the
+// multiplication and division signs (which are not letters) are left alone.
+static const char * const LATIN1_BASE[64] = {
+	"a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+	"d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th", "ss",
+	"a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+	"d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th", "y"};
+
+// This struct will hold our place in a name while it is folded into a sort key, one byte at a time.
+struct foldCursor
+{
+	const unsigned char * next; // The next byte of the name to fold
+	int pending; // A byte that has been folded but not returned yet, or 0 if there is none
+};
+
+// This function will return the next byte of the sort key for a name, or 0 at the end of the name. Under binary
+// collation every byte is kept as it is. Otherwise ASCII uppercase letters are folded to lowercase, and so are the
+// uppercase Latin-1 letters (written in UTF-8 as 0xC3 followed by a byte from 0x80 to 0x9E). When accents are
+// ignored as well, each Latin-1 letter is folded to the plain letters in the table above. A folded letter is never
+// longer than the bytes it came from, so a sort key is never longer than its name. Any other bytes, such as the
+// rest of UTF-8, are kept as they are.
+static int foldNext(foldCursor & cursor, int collation)
+{
+	if(cursor.pending)
+	{
+		int folded = cursor.pending;
+		cursor.pending = 0;
+		return folded;
+	}
+	unsigned char current = *cursor.next;
+	if(!current)
+		return 0;
+	++cursor.next;
+	if(collation == COLLATE_BINARY)
+		return current;
+	if(current >= 'A' && current <= 'Z')
+		return current + ('a' - 'A');
+	if(current != 0xC3 || *cursor.next < 0x80 || *cursor.next > 0xBF)
+		return current;
+	unsigned char second = *cursor.next++;
+	if(collation == COLLATE_ACCENTS && LATIN1_BASE[second - 0x80])
+	{
+		const char * base = LATIN1_BASE[second - 0x80];
+		cursor.pending = static_cast<unsigned char>(base[1]);
+		return static_cast<unsigned char>(base[0]);
+	}
+	// Fold the uppercase letters to lowercase- the multiplication sign at 0x97 is not a letter
+	if(second <= 0x9E && second != 0x97)
+		second += 0x20;
+	cursor.pending = second;
+	return current;
+}
+
+/******************** catalogStatistics Class: *******************************************/
+
+// The least cost counted in each bucket of the cost histogram after the first, which holds the free activities
+static const float COST_BUCKET_LIMITS[COST_BUCKETS - 1] = {0.01f, 10, 25, 50, 100, 200};
+
+// This function serves as the constructor for the catalogStatistics class, starting with nothing counted.
+catalogStatistics::catalogStatistics()
+{
+	reset();
+}
+
+// This function will forget every activity and location counted so far, for when a list is emptied.
+int catalogStatistics::reset()
+{
+	costs.clear();
+	totalCost = 0;
+	totalParking = 0;
+	for(int i = 0; i < COST_BUCKETS; ++i)
+		costHistogram[i] = 0;
+	return 1;
+}
+
+// This function will find the bucket of the cost histogram a cost is counted in. There are only a few buckets, so
+// checking each limit in turn is as fast as anything cleverer.
+int catalogStatistics::bucketOf(float cost)
+{
+	int bucket = 0;
+	while(bucket < COST_BUCKETS - 1 && cost >= COST_BUCKET_LIMITS[bucket])
+		++bucket;
+	return bucket;
+}
+
+// This function will count the cost of an activity that was just added to the list.
+int catalogStatistics::addCost(float cost)
+{
+	costs.insert(cost);
+	totalCost += cost;
+	++costHistogram[bucketOf(cost)];
+	return 1;
+}
+
+// This function will stop counting the cost of an activity that was just removed from the list. Only one copy of the
+// cost is removed, since several activities can have the same cost. Returns 0 if the cost was never counted.
+int catalogStatistics::removeCost(float cost)
+{
+	multiset<float>::iterator found = costs.find(cost);
+	if(found == costs.end())
+		return 0;
+	costs.erase(found);
+	totalCost -= cost;
+	--costHistogram[bucketOf(cost)];
+	// Start the total over once the list is empty, so rounding errors cannot build up forever
+	if(costs.empty())
+		totalCost = 0;
+	return 1;
+}
+
+int catalogStatistics::addParking(int numSpots)
+{
+	totalParking += numSpots;
+	return 1;
+}
+
+int catalogStatistics::removeParking(int numSpots)
+{
+	totalParking -= numSpots;
+	return 1;
+}
+
+// This function will fill in the cost and parking fields of a summary. The costs are kept in order, so the cheapest
+// and most expensive are at either end. The counts of activities and locations are left for the caller to fill in.
+int catalogStatistics::getSummary(catalogSummary & summary)
+{
+	summary.totalParking = totalParking;
+	summary.minCost = summary.maxCost = summary.averageCost = 0;
+	if(!costs.empty())
+	{
+		summary.minCost = *costs.begin();
+		summary.maxCost = *costs.rbegin();
+		summary.averageCost = totalCost / costs.size();
+	}
+	for(int i = 0; i < COST_BUCKETS; ++i)
+		summary.costHistogram[i] = costHistogram[i];
+	return 1;
+}
+
 /******************** activityData Class: *******************************************/
 
 // This function will serve as the default constructor of the activityData class. The constructor will initialize all
@@ -16,6 +726,10 @@ activityData::activityData()
 	description = nullptr;
 	equipment = nullptr;
 	cost = 0.0;
+	sortKey = nullptr;
+	ownsKey = false;
+	keyPrefix = 0;
+	collation = DEFAULT_COLLATION;
 
 	/* For testing purposes:
 	if(!name && !description && !equipment && cost == 0.0)
@@ -27,6 +741,8 @@ activityData::activityData()
 // allocated to the activityData class object upon the expiry of its lifetime. 
 activityData::~activityData()
 {
+	// The sort key may share the memory of the name, so release it first
+	releaseKey();
 	// Release memory of dynamically allocated char arrays
 	if(name)
 		delete [] name;
@@ -42,15 +758,22 @@ activityData::~activityData()
 // This function will take in the name of an activity (char array), a description of the activity (char array), any 
 // equipment needed for the activity (char array) and the cost of the activity (char array) from the client program
 // and will read the data into an activityData class object. The function will dynamically allocate the necessary
-// memory for the char arrays name, description, and equipment, and will copy the passed in arrays over.
+// memory for the char arrays name, description, and equipment, and will copy the passed in arrays over. A cost that
+// is negative, infinite or not a number (which could come from a damaged snapshot or a client of the server) is
+// rejected, since it could not be ordered among the other costs in the summary.
 // If the function successfully loads the passed data to the activityData object, a 1 will be returned- signifying
 // success. If the function cannot successfully load the data to the activityData object, a 0 will be returned-
 // signiftying failure
 int activityData::loadActivity(char passedName[], char passedDescription[], char passedEquipment[], float passedCost)
 {
-	// Ensure that no null values have been passed in arrays, and that cost is not negative
-	if(!passedName || !passedDescription || !passedEquipment || 0 > passedCost)
+	// Ensure that no null values have been passed in arrays, and that cost is a number that is not negative
+	if(!passedName || !passedDescription || !passedEquipment || !isfinite(passedCost) || 0 > passedCost)
 		return 0; 
+	// Release any data already loaded into this object
+	releaseKey();
+	delete [] name;
+	delete [] description;
+	delete [] equipment;
 	// Allocate memory for name and copy over
 	name = new char[strlen(passedName) + 1];
 	strcpy(name, passedName);
@@ -62,6 +785,8 @@ int activityData::loadActivity(char passedName[], char passedDescription[], char
 	strcpy(equipment, passedEquipment);
 	// Copy over cost
 	cost = passedCost;
+	// Build the sort key once now, so comparing names later does not need to fold them again
+	buildKey();
 	return 1;
 }
 
@@ -78,36 +803,147 @@ int activityData::copyActivity(activityData & passedActivity)
 
 // This function will display the data members of an activityData object, allowing for the client program to display 
 // information on a snow activity to the user
-int activityData::display()
+int activityData::display(ostream & out)
 {
-	cout << "Name: " << name << endl << "Description: " << description << endl << "Equipment Needed: " << equipment
+	out << "Name: " << name << endl << "Description: " << description << endl << "Equipment Needed: " << equipment
 	     << endl << "Cost: " << cost << endl << endl;
 	return 1;
 }
 
 
-// Compares to see if the name passed in via argument is the same as the name of an activityData object- if the
-// names match, return true
+// Compares to see if the name passed in via argument is the same as the name of an activityData object under the
+// collation of the activity- if the names match, return true
 bool activityData::isMatch(char * passedName)
 {
-	if(strcmp(name, passedName) == 0)
+	if(compareName(passedName) == 0)
 		return true;
 	else
 		return false;
 }
 
-// This function compares the name of a passed activity object to the name of the calling activityData object using
-// strcmp, and returns the value of the compare function. This allows for direct access to the names of the
-// activityData objects, which will make it easier to avoid using getter functions in our ADT. The function will
-// return a value greater than zero if the passed activity belongs before the calling activity in the list,
-// zero if the two activities have the same name, or a negative value if the passed activity goes after the
-// calling activity in the list.
+// This function compares the sort key of a passed activity object to the sort key of the calling activityData object,
+// and returns the result. This allows for direct access to the names of the activityData objects, which will make it
+// easier to avoid using getter functions in our ADT. The function will return a value greater than zero if the passed
+// activity belongs before the calling activity in the list, zero if the two activities have the same name under the
+// collation, or a negative value if the passed activity goes after the calling activity in the list.
+// The key prefixes are compared first, which settles most comparisons with a single integer compare. Only when the
+// first 8 bytes of both keys match do we need to look at the rest of the keys. If the passed activity was keyed under
+// a different collation, its key is rebuilt to match ours first.
 int activityData::compareName(activityData & passedActivity)
 {
-	return strcmp(name, passedActivity.name);
+	if(passedActivity.collation != collation)
+		passedActivity.setCollation(collation);
+	if(keyPrefix != passedActivity.keyPrefix)
+		return keyPrefix < passedActivity.keyPrefix ? -1 : 1;
+	// The prefixes are padded with zeroes, so if the last byte is zero the keys ended within the prefix, and are equal
+	if(!(keyPrefix & 0xFF))
+		return 0;
+	return strcmp(sortKey + KEY_PREFIX_BYTES, passedActivity.sortKey + KEY_PREFIX_BYTES);
+}
+
+// This function compares the name of the calling activityData object with a name passed in, under the collation of
+// the activity. The passed name is folded as it is compared, so no sort key needs to be built for it.
+int activityData::compareName(char * passedName)
+{
+	return collateCompare(name, passedName, collation);
+}
+
+// This function hashes the sort key of the activity using the hashName function below. This allows the sharded list
+// to decide which shard an activity belongs in without direct access to its name, and since the key is hashed
+// rather than the name, names that match under the collation end up in the same shard.
+unsigned int activityData::hashName()
+{
+	return ::hashName(sortKey ? sortKey : "");
+}
+
+// This function will set the collation used to order and match the name of the activity. The sort key is only
+// rebuilt if the collation changes. Returns 0 if the collation is not valid, or 1 on success.
+int activityData::setCollation(int mode)
+{
+	if(mode < COLLATE_BINARY || mode > COLLATE_ACCENTS)
+		return 0;
+	if(mode == collation && (sortKey || !name))
+		return 1;
+	collation = mode;
+	buildKey();
+	return 1;
+}
+
+// This function will build just the sort key for a name, without loading the rest of the activity. The activity
+// index uses an object loaded this way to search for an activity by name, so that the name is folded once for the
+// search rather than once for every activity it is compared against. A search happens far more often than an activity
+// is added, so the key is not allocated: under binary collation the key is the passed name itself, and otherwise it
+// is folded into the buffer passed in, if it fits (a key is never longer than its name). Both must outlive this
+// object. Returns 0 if the name is null or the collation is not valid, or 1 on success.
+int activityData::loadKey(char * passedName, int mode, char keyBuffer[], int size)
+{
+	if(!passedName || mode < COLLATE_BINARY || mode > COLLATE_ACCENTS)
+		return 0;
+	releaseKey();
+	collation = mode;
+	if(mode == COLLATE_BINARY)
+		sortKey = passedName;
+	else if(static_cast<int>(strlen(passedName)) < size)
+	{
+		foldCursor cursor = {reinterpret_cast<const unsigned char *>(passedName), 0};
+		int length = 0;
+		while((keyBuffer[length] = foldNext(cursor, mode)))
+			++length;
+		sortKey = keyBuffer;
+	}
+	else
+	{
+		sortKey = makeSortKey(passedName, mode);
+		ownsKey = true;
+	}
+	packPrefix();
+	return 1;
+}
+
+// This function will build the sort key from the name under the current collation, and pack its first 8 bytes into
+// the key prefix. Under binary collation the key of the name is exactly the name, so the name is shared rather than
+// copied.
+void activityData::buildKey()
+{
+	releaseKey();
+	if(!name)
+		return;
+	if(collation == COLLATE_BINARY)
+		sortKey = name;
+	else
+	{
+		sortKey = makeSortKey(name, collation);
+		ownsKey = true;
+	}
+	packPrefix();
+}
+
+// This function will pack the first 8 bytes of the sort key into the key prefix, with the first byte highest so that
+// comparing prefixes as integers orders them the same way as strcmp. A key shorter than the prefix is padded with
+// zeroes.
+void activityData::packPrefix()
+{
+	keyPrefix = 0;
+	bool ended = false;
+	for(int i = 0; i < KEY_PREFIX_BYTES; ++i)
+	{
+		if(!ended && !sortKey[i])
+			ended = true;
+		keyPrefix = keyPrefix << 8 | (ended ? 0 : static_cast<unsigned char>(sortKey[i]));
+	}
+}
+
+// This function will release the sort key, unless it shares the memory of the name or of a buffer passed to loadKey.
+void activityData::releaseKey()
+{
+	if(ownsKey)
+		delete [] sortKey;
+	sortKey = nullptr;
+	ownsKey = false;
+	keyPrefix = 0;
 }
 
-int activityData::write(ofstream & outFile)
+int activityData::write(ostream & outFile)
 {
     if(!outFile) return -1;
     outFile << "Activity Name: " << name << '\n'
@@ -117,13 +953,756 @@ int activityData::write(ofstream & outFile)
     return 1;
 }
 
+// This function will append the name of the activity to a front-coded name index. Used by the activityList class to
+// build an index of the names in the list without needing direct access to the name.
+int activityData::writeName(nameBlockIndex & index)
+{
+	return index.addName(name);
+}
 
+// This function will write just the name of the activity to a stream, for listing the activity alongside other
+// information without displaying all of its data.
+int activityData::writeName(ostream & out)
+{
+	out << name;
+	return out ? 1 : -1;
+}
 
-//**************** activityList Class: ********************************
+// This function will write the name of the activity to a binary patch file, where each change names the activity it
+// applies to. A change that needs the rest of the activity writes it after the name using writeRecord.
+int activityData::writePatchName(ofstream & outFile)
+{
+	if(!outFile) return -1;
+	writeString(outFile, name);
+	return outFile ? 1 : -1;
+}
 
-// This function serves as the default constructor for our ADT activitiesList class. The constructor will set the
-// head pointer to the list of activity nodes to null.
-activityList::activityList()
+// This function will determine if every field of an activity is exactly the same as the passed activity, including
+// any differences in the name that the collation ignores. Used to find the activities that changed between two
+// versions of a list.
+bool activityData::sameAs(activityData & passedActivity)
+{
+	return strcmp(name, passedActivity.name) == 0 && strcmp(description, passedActivity.description) == 0
+	       && strcmp(equipment, passedActivity.equipment) == 0 && cost == passedActivity.cost;
+}
+
+// These functions will count the cost of the activity in a set of statistics, or stop counting it, so that the
+// activityList class can keep its statistics up to date without needing direct access to the cost.
+int activityData::addCostTo(catalogStatistics & statistics)
+{
+	return statistics.addCost(cost);
+}
+
+int activityData::removeCostFrom(catalogStatistics & statistics)
+{
+	return statistics.removeCost(cost);
+}
+
+// This function will write the description, equipment and cost of the activity to a binary snapshot file. The name
+// is not written here, since snapshots store all of the names together in a front-coded name index.
+int activityData::writeRecord(ofstream & outFile)
+{
+	if(!outFile) return -1;
+	writeString(outFile, description);
+	writeString(outFile, equipment);
+	outFile.write(reinterpret_cast<char *>(&cost), sizeof(cost));
+	return outFile ? 1 : -1;
+}
+
+
+
+//**************** activityIndex Class: ********************************
+
+// This function serves as the default constructor for the activityIndex class. The constructor creates the header
+// and tail nodes, linking the header directly to the tail at every level. Each of those links skips over one
+// position- the tail itself.
+activityIndex::activityIndex()
+{
+	header = new indexNode;
+	tail = new indexNode;
+	header -> activity = tail -> activity = nullptr;
+	header -> numLevels = INDEX_MAX_LEVEL;
+	header -> forward = new indexNode * [INDEX_MAX_LEVEL];
+	header -> width = new int[INDEX_MAX_LEVEL];
+	tail -> numLevels = 0;
+	tail -> forward = nullptr;
+	tail -> width = nullptr;
+	for(int i = 0; i < INDEX_MAX_LEVEL; ++i)
+	{
+		header -> forward[i] = tail;
+		header -> width[i] = 1;
+	}
+	count = 0;
+	seed = 2463534242u;
+	collation = DEFAULT_COLLATION;
+}
+
+// This function serves as the destructor for the activityIndex class, and releases all of the index nodes. The
+// activity nodes they refer to belong to the activityList class, and are not released here.
+activityIndex::~activityIndex()
+{
+	removeAll();
+	delete [] header -> forward;
+	delete [] header -> width;
+	delete header;
+	delete tail;
+}
+
+// This function will release all of the index nodes between the header and the tail, leaving the index empty.
+int activityIndex::removeAll()
+{
+	indexNode * current = header -> forward[0];
+	while(current != tail)
+	{
+		indexNode * temp = current -> forward[0];
+		delete [] current -> forward;
+		delete [] current -> width;
+		delete current;
+		current = temp;
+	}
+	for(int i = 0; i < INDEX_MAX_LEVEL; ++i)
+	{
+		header -> forward[i] = tail;
+		header -> width[i] = 1;
+	}
+	count = 0;
+	return 1;
+}
+
+// This function will pick the number of levels for a new index node. Each node has a one in four chance of having
+// each additional level, which keeps the number of links we follow during a search to O(log n).
+int activityIndex::randomLevel()
+{
+	// xorshift random number generator
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	int level = 1;
+	unsigned int bits = seed;
+	while(level < INDEX_MAX_LEVEL && (bits & 3) == 0)
+	{
+		++level;
+		bits >>= 2;
+	}
+	return level;
+}
+
+// This function will search the index for the position of an activity. To search for a name, the caller passes in
+// an activity loaded with just that name and its key prefix.
+// At each level, starting from the top, we follow forward pointers as long as they lead to an activity that comes
+// before the one we are looking for (or is the same, if inclusive is true). The last index node we reach at each
+// level is saved in update, and its position in steps, so that the links can be changed by insert and remove.
+// Returns the position of the last index node reached- the number of activities before the one we are looking for.
+int activityIndex::search(activityData & passedActivity, bool inclusive, indexNode * update[], int steps[])
+{
+	indexNode * current = header;
+	int position = 0;
+	for(int i = INDEX_MAX_LEVEL - 1; i >= 0; --i)
+	{
+		while(current -> forward[i] != tail)
+		{
+			activityData & next = current -> forward[i] -> activity -> activity;
+			int compare = next.compareName(passedActivity);
+			if(compare > 0 || (compare == 0 && !inclusive))
+				break;
+			position += current -> width[i];
+			current = current -> forward[i];
+		}
+		if(update)
+		{
+			update[i] = current;
+			steps[i] = position;
+		}
+	}
+	return position;
+}
+
+// This function will add an activity node to the index, in alphabetical order. The previous pointer is set to the
+// activity node that the new activity belongs after in the list of activities, or to null if it belongs at the front.
+// Returns the rank of the new activity, or -1 if an activity with the same name is already in the index.
+int activityIndex::insert(activityNode * newActivity, activityNode * & previous)
+{
+	indexNode * update[INDEX_MAX_LEVEL];
+	int steps[INDEX_MAX_LEVEL];
+	int position = search(newActivity -> activity, false, update, steps);
+	indexNode * next = update[0] -> forward[0];
+	if(next != tail && next -> activity -> activity.compareName(newActivity -> activity) == 0)
+		return -1;
+	previous = update[0] -> activity;
+
+	// Create the new index node, and link it in after the last node we reached at each of its levels
+	indexNode * temp = new indexNode;
+	temp -> activity = newActivity;
+	temp -> numLevels = randomLevel();
+	temp -> forward = new indexNode * [temp -> numLevels];
+	temp -> width = new int[temp -> numLevels];
+	for(int i = 0; i < temp -> numLevels; ++i)
+	{
+		// The link from update[i] is split in two around the new node
+		temp -> forward[i] = update[i] -> forward[i];
+		update[i] -> forward[i] = temp;
+		temp -> width[i] = update[i] -> width[i] - (position - steps[i]);
+		update[i] -> width[i] = position - steps[i] + 1;
+	}
+	// The links above the new node now skip over one more activity
+	for(int i = temp -> numLevels; i < INDEX_MAX_LEVEL; ++i)
+		++update[i] -> width[i];
+	++count;
+	return position;
+}
+
+// This function will remove the activity with the passed name from the index. The previous pointer is set to the
+// activity node before it in the list of activities, or to null if it is the first activity. Returns the activity
+// node that was removed, or null if no activity with that name is in the index.
+activityNode * activityIndex::remove(char * activityName, activityNode * & previous)
+{
+	indexNode * update[INDEX_MAX_LEVEL];
+	int steps[INDEX_MAX_LEVEL];
+	char keyBuffer[PROBE_KEY_SIZE];
+	activityData probe;
+	if(!probe.loadKey(activityName, collation, keyBuffer, PROBE_KEY_SIZE))
+		return nullptr;
+	search(probe, false, update, steps);
+	indexNode * target = update[0] -> forward[0];
+	if(target == tail || target -> activity -> activity.compareName(probe) != 0)
+		return nullptr;
+	previous = update[0] -> activity;
+
+	for(int i = 0; i < INDEX_MAX_LEVEL; ++i)
+	{
+		// Links that pointed to the removed node now point past it- all others skip one less activity
+		if(update[i] -> forward[i] == target)
+		{
+			update[i] -> width[i] += target -> width[i] - 1;
+			update[i] -> forward[i] = target -> forward[i];
+		}
+		else
+			--update[i] -> width[i];
+	}
+	activityNode * removed = target -> activity;
+	delete [] target -> forward;
+	delete [] target -> width;
+	delete target;
+	--count;
+	return removed;
+}
+
+// This function will find the activity node with the passed name, returning null if it is not in the index.
+activityNode * activityIndex::find(char * activityName)
+{
+	if(!activityName)
+		return nullptr;
+	indexNode * update[INDEX_MAX_LEVEL];
+	int steps[INDEX_MAX_LEVEL];
+	char keyBuffer[PROBE_KEY_SIZE];
+	activityData probe;
+	probe.loadKey(activityName, collation, keyBuffer, PROBE_KEY_SIZE);
+	search(probe, false, update, steps);
+	indexNode * next = update[0] -> forward[0];
+	if(next == tail || next -> activity -> activity.compareName(probe) != 0)
+		return nullptr;
+	return next -> activity;
+}
+
+// This function will find the activity node at the passed rank (its position in the list, counting from zero), by
+// following the widest links that do not skip past it. Returns null if the rank is out of range.
+activityNode * activityIndex::atRank(int rank)
+{
+	if(rank < 0 || rank >= count)
+		return nullptr;
+	// The header is at position 0, so the activity at rank r is at position r + 1
+	int target = rank + 1;
+	int position = 0;
+	indexNode * current = header;
+	for(int i = INDEX_MAX_LEVEL - 1; i >= 0; --i)
+		while(current -> forward[i] != tail && position + current -> width[i] <= target)
+		{
+			position += current -> width[i];
+			current = current -> forward[i];
+		}
+	return current -> activity;
+}
+
+// This function will find the rank of the activity with the passed name, or return -1 if it is not in the index.
+int activityIndex::rankOf(char * activityName)
+{
+	if(!activityName)
+		return -1;
+	indexNode * update[INDEX_MAX_LEVEL];
+	int steps[INDEX_MAX_LEVEL];
+	char keyBuffer[PROBE_KEY_SIZE];
+	activityData probe;
+	probe.loadKey(activityName, collation, keyBuffer, PROBE_KEY_SIZE);
+	int position = search(probe, false, update, steps);
+	indexNode * next = update[0] -> forward[0];
+	if(next == tail || next -> activity -> activity.compareName(probe) != 0)
+		return -1;
+	return position;
+}
+
+// This function will count the activities in the index that come before the passed activity alphabetically. If
+// inclusive is true, an activity with the same name is counted as well. The passed activity does not need to be in
+// the index.
+int activityIndex::countBefore(activityData & passedActivity, bool inclusive)
+{
+	return search(passedActivity, inclusive, nullptr, nullptr);
+}
+
+int activityIndex::getCount()
+{
+	return count;
+}
+
+// This function will set the collation the index orders activities by. The order of the activities already in the
+// index would be wrong under a different collation, so the collation can only be changed while the index is empty.
+// Returns 0 if the collation is not valid or the index is not empty, or 1 on success.
+int activityIndex::setCollation(int mode)
+{
+	if(mode < COLLATE_BINARY || mode > COLLATE_ACCENTS || (count && mode != collation))
+		return 0;
+	collation = mode;
+	return 1;
+}
+
+int activityIndex::getCollation()
+{
+	return collation;
+}
+
+//**************** locationTable Class: ********************************
+
+// This function serves as the default constructor for the locationTable class, and sets the table to empty.
+locationTable::locationTable()
+{
+	policies = nullptr;
+	parking = nullptr;
+	locations = nullptr;
+	owners = nullptr;
+	count = capacity = 0;
+}
+
+// This function serves as the destructor for the locationTable class, and releases the arrays. The locations and
+// activities they point to belong to the activityList class, and are not released here.
+locationTable::~locationTable()
+{
+	delete [] policies;
+	delete [] parking;
+	delete [] locations;
+	delete [] owners;
+}
+
+// This function will add a location to the end of the table, recording its reservation policy and parking along
+// with the activity it belongs to, and will set the slot of the location to its position in the table. The arrays
+// double in size when they are full.
+int locationTable::add(locationNode * location, activityNode * owner)
+{
+	if(!location)
+		return 0;
+	if(count == capacity)
+	{
+		int newCapacity = capacity ? capacity * 2 : 64;
+		unsigned char * newPolicies = new unsigned char[newCapacity];
+		int * newParking = new int[newCapacity];
+		locationNode ** newLocations = new locationNode * [newCapacity];
+		activityNode ** newOwners = new activityNode * [newCapacity];
+		if(count)
+		{
+			memcpy(newPolicies, policies, count * sizeof(unsigned char));
+			memcpy(newParking, parking, count * sizeof(int));
+			memcpy(newLocations, locations, count * sizeof(locationNode *));
+			memcpy(newOwners, owners, count * sizeof(activityNode *));
+		}
+		delete [] policies;
+		delete [] parking;
+		delete [] locations;
+		delete [] owners;
+		policies = newPolicies;
+		parking = newParking;
+		locations = newLocations;
+		owners = newOwners;
+		capacity = newCapacity;
+	}
+	policies[count] = location -> reservationPolicy;
+	parking[count] = location -> numParkingSpots;
+	locations[count] = location;
+	owners[count] = owner;
+	location -> slot = count++;
+	return 1;
+}
+
+// This function will remove a location from the table by moving the last location in the table into its slot.
+// Returns 0 if the location is not in the table, or 1 on success.
+int locationTable::remove(locationNode * location)
+{
+	int slot = location ? location -> slot : -1;
+	if(slot < 0 || slot >= count || locations[slot] != location)
+		return 0;
+	--count;
+	if(slot != count)
+	{
+		policies[slot] = policies[count];
+		parking[slot] = parking[count];
+		locations[slot] = locations[count];
+		owners[slot] = owners[count];
+		locations[slot] -> slot = slot;
+	}
+	location -> slot = -1;
+	return 1;
+}
+
+// This function will remove every location from the table, keeping the arrays for the locations added later.
+int locationTable::removeAll()
+{
+	count = 0;
+	return 1;
+}
+
+// This function will find the first slot at or after start whose location matches a filter. A location matches if
+// the flags of its reservation policy selected by policyMask are exactly those in policyValue, and it has at least
+// minSpots parking spots. For example, a mask of RESERVATION_REQUIRED and a value of 0 matches every location that
+// does not require reservations. Only the packed arrays are read, so checking each location is a couple of integer
+// comparisons. Returns the slot found, or -1 if no more locations match.
+int locationTable::findNext(int start, unsigned char policyMask, unsigned char policyValue, int minSpots)
+{
+	for(int slot = start < 0 ? 0 : start; slot < count; ++slot)
+		if((policies[slot] & policyMask) == policyValue && parking[slot] >= minSpots)
+			return slot;
+	return -1;
+}
+
+locationNode * locationTable::getLocation(int slot)
+{
+	return slot >= 0 && slot < count ? locations[slot] : nullptr;
+}
+
+activityNode * locationTable::getActivity(int slot)
+{
+	return slot >= 0 && slot < count ? owners[slot] : nullptr;
+}
+
+int locationTable::getCount()
+{
+	return count;
+}
+
+//**************** activityCursor Class: ********************************
+
+// This function serves as the default constructor for the activityCursor class, and places the cursor before the
+// first activity in the list.
+activityCursor::activityCursor()
+{
+	atStart = true;
+	passed = 0;
+}
+
+// This function serves as the copy constructor for the activityCursor class. The last activity owns its own dynamic
+// memory, so the copy loads its own copy of it rather than sharing the same arrays.
+activityCursor::activityCursor(const activityCursor & passedCursor)
+{
+	atStart = true;
+	passed = 0;
+	*this = passedCursor;
+}
+
+// This function will copy the position of another cursor into this one, loading a copy of its last activity. A
+// cursor still at the start has no last activity to copy. Returns this cursor.
+activityCursor & activityCursor::operator=(const activityCursor & passedCursor)
+{
+	if(this == &passedCursor)
+		return *this;
+	atStart = passedCursor.atStart;
+	passed = passedCursor.passed;
+	if(!atStart)
+		last.copyActivity(const_cast<activityData &>(passedCursor.last));
+	return *this;
+}
+
+int activityCursor::getPassed()
+{
+	return passed;
+}
+
+//**************** snapshotReader Class: ********************************
+
+// This function serves as the constructor for the snapshotReader class, which starts with no snapshot open.
+snapshotReader::snapshotReader()
+{
+	version = 0;
+	collation = COLLATE_BINARY;
+	position = 0;
+	name = nullptr;
+	error = false;
+}
+
+// This function serves as the destructor for the snapshotReader class, and releases the buffer for names. The name
+// index and the file release themselves.
+snapshotReader::~snapshotReader()
+{
+	delete [] name;
+}
+
+// This function will open a snapshot file and read everything that comes before the first activity: the version,
+// the collation (snapshots before version 3 are always in binary order), and the front-coded name index. Returns -1
+// if the file could not be opened, 0 if it is not a valid snapshot, or 1 on success.
+int snapshotReader::open(char * fileName)
+{
+	inFile.open(fileName, ios::binary);
+	if(!inFile)
+		return -1;
+	error = true;
+	char magic[4];
+	inFile.read(magic, 4);
+	if(!inFile || strncmp(magic, SNAPSHOT_MAGIC, 4) != 0 || !readInt(inFile, version) || version < 1
+	   || version > SNAPSHOT_VERSION)
+		return 0;
+	collation = COLLATE_BINARY;
+	if(version > SNAPSHOT_BINARY_COLLATION
+	   && (!readInt(inFile, collation) || collation < COLLATE_BINARY || collation > COLLATE_ACCENTS))
+		return 0;
+	if(!names.read(inFile))
+		return 0;
+	names.setCollation(collation);
+	delete [] name;
+	name = new char[names.getLongest() + 1];
+	position = 0;
+	error = false;
+	return 1;
+}
+
+// This function will read the next activity in the snapshot, along with its locations, into a new activity node.
+// The activities come out in the order they were written, which is the order of the list the snapshot was taken of.
+// Returns null once every activity has been read, or if the file turns out not to be a valid snapshot (which the
+// failed function reports).
+activityNode * snapshotReader::next()
+{
+	if(error || !name || position >= names.getCount())
+		return nullptr;
+	names.getName(position, name, names.getLongest() + 1);
+	activityNode * temp = readActivity(inFile, name, collation, version);
+	if(!temp)
+	{
+		error = true;
+		return nullptr;
+	}
+	++position;
+	return temp;
+}
+
+int snapshotReader::getCollation()
+{
+	return collation;
+}
+
+int snapshotReader::getCount()
+{
+	return names.getCount();
+}
+
+// This function will find the rank of the activity with the passed name in the snapshot (its position, counting from
+// zero), using only the front-coded name index read when the snapshot was opened. No activities are read, so this
+// is quick however large the snapshot is. The name is matched under the collation of the snapshot. Returns the rank,
+// or -1 if the activity is not in the snapshot or no snapshot is open.
+int snapshotReader::rankOf(char * activityName)
+{
+	if(error || !name)
+		return -1;
+	return names.find(activityName);
+}
+
+bool snapshotReader::failed()
+{
+	return error;
+}
+
+//**************** deltaSource Class: ********************************
+
+// These functions serve as the constructors for the deltaSource class. A source walking a live list starts at the
+// head of the list, while a source reading a snapshot reads the first activity right away.
+deltaSource::deltaSource(activityList & passedList)
+{
+	node = passedList.head;
+	reader = nullptr;
+	collation = passedList.getCollation();
+}
+
+deltaSource::deltaSource(snapshotReader & passedReader)
+{
+	reader = &passedReader;
+	collation = reader -> getCollation();
+	node = reader -> next();
+}
+
+// This function serves as the destructor for the deltaSource class. The activities read from a snapshot belong to
+// the source, so the one it is at is released- the activities of a live list belong to the list.
+deltaSource::~deltaSource()
+{
+	if(reader)
+		releaseDetached(node);
+}
+
+activityNode * deltaSource::current()
+{
+	return node;
+}
+
+// This function will move the source on to the next activity. An activity read from a snapshot is released once the
+// source moves past it, so only one activity from the snapshot is held at a time. Returns 0 if the source was already
+// past the last activity, or 1 otherwise.
+int deltaSource::advance()
+{
+	if(!node)
+		return 0;
+	if(reader)
+	{
+		releaseDetached(node);
+		node = reader -> next();
+	}
+	else
+		node = node -> next;
+	return 1;
+}
+
+int deltaSource::getCollation()
+{
+	return collation;
+}
+
+bool deltaSource::failed()
+{
+	return reader && reader -> failed();
+}
+
+// Returns whether every field of two locations is exactly the same.
+static bool sameLocation(locationNode * first, locationNode * second)
+{
+	if(strcmp(first -> name, second -> name) != 0 || strcmp(first -> description, second -> description) != 0
+	   || first -> reservationPolicy != second -> reservationPolicy
+	   || first -> numParkingSpots != second -> numParkingSpots)
+		return false;
+	if(!first -> reservationDetail || !second -> reservationDetail)
+		return first -> reservationDetail == second -> reservationDetail;
+	return strcmp(first -> reservationDetail, second -> reservationDetail) == 0;
+}
+
+// Returns the number of locations at the end of two lists of locations that are exactly the same. New locations are
+// added to the front of the list, so the locations an activity had before are usually all at the end.
+static int commonSuffix(locationNode * first, int numFirst, locationNode * second, int numSecond)
+{
+	// Line the two lists up at their ends, then count how many matching locations there are in a row at the end
+	for(; numFirst > numSecond; --numFirst)
+		first = first -> next;
+	for(; numSecond > numFirst; --numSecond)
+		second = second -> next;
+	int common = 0;
+	for(; first && second; first = first -> next, second = second -> next)
+		common = sameLocation(first, second) ? common + 1 : 0;
+	return common;
+}
+
+// Returns the number of locations in a list of locations.
+static int countChain(locationNode * location)
+{
+	int count = 0;
+	for(; location; location = location -> next)
+		++count;
+	return count;
+}
+
+// This function will compare two versions of a list of activities and write the changes between them to a patch
+// file. Both versions are in order under the same collation, so they can be walked side by side, much like merging
+// two sorted piles of cards: if the next activity in the older version comes first, it was removed; if the next
+// activity in the newer version comes first, it was added; and if they have the same name, the activity and its
+// locations are compared to see what changed. Only the locations that changed are written- the locations at the end
+// of the list that stayed the same are kept. Only one activity from each version is looked at at a time, so neither
+// version needs to be held in memory if it is read from a snapshot. Returns the number of changes written, or -1 if
+// the versions are ordered by different collations, a snapshot could not be read, or the patch could not be written.
+static int mergeDelta(deltaSource & older, deltaSource & newer, char * patchFile)
+{
+	if(older.getCollation() != newer.getCollation())
+		return -1;
+	ofstream outFile(patchFile, ios::binary);
+	if(!outFile)
+		return -1;
+	outFile.write(PATCH_MAGIC, 4);
+	writeInt(outFile, PATCH_VERSION);
+	writeInt(outFile, newer.getCollation());
+
+	int changes = 0;
+	while(outFile && (older.current() || newer.current()))
+	{
+		activityNode * oldActivity = older.current();
+		activityNode * newActivity = newer.current();
+		int compare = !oldActivity ? 1 : !newActivity ? -1 : oldActivity -> activity.compareName(newActivity -> activity);
+		if(compare < 0)
+		{
+			// The activity is only in the older version
+			outFile.put(PATCH_REMOVE_ACTIVITY);
+			oldActivity -> activity.writePatchName(outFile);
+			++changes;
+			older.advance();
+		}
+		else if(compare > 0)
+		{
+			// The activity is only in the newer version
+			outFile.put(PATCH_ADD_ACTIVITY);
+			newActivity -> activity.writePatchName(outFile);
+			newActivity -> activity.writeRecord(outFile);
+			writeLocations(outFile, newActivity -> head, countChain(newActivity -> head));
+			++changes;
+			newer.advance();
+		}
+		else
+		{
+			if(!oldActivity -> activity.sameAs(newActivity -> activity))
+			{
+				outFile.put(PATCH_UPDATE_ACTIVITY);
+				newActivity -> activity.writePatchName(outFile);
+				newActivity -> activity.writeRecord(outFile);
+				++changes;
+			}
+			int numOld = countChain(oldActivity -> head);
+			int numNew = countChain(newActivity -> head);
+			int common = commonSuffix(oldActivity -> head, numOld, newActivity -> head, numNew);
+			if(common < numOld || common < numNew)
+			{
+				// Remove the locations in front of the ones that stayed the same, and put the new ones there instead
+				outFile.put(PATCH_UPDATE_LOCATIONS);
+				newActivity -> activity.writePatchName(outFile);
+				writeInt(outFile, numOld - common);
+				writeLocations(outFile, newActivity -> head, numNew - common);
+				++changes;
+			}
+			older.advance();
+			newer.advance();
+		}
+	}
+	if(older.failed() || newer.failed())
+		return -1;
+	outFile.put(PATCH_END);
+	writeInt(outFile, changes);
+	return outFile ? changes : -1;
+}
+
+// This function will write a patch holding the changes that turn one snapshot into another. Both snapshots are read
+// one activity at a time as they are compared, so neither needs to be loaded into a list. The snapshots must be
+// ordered by the same collation. Returns the number of changes written, or -1 if either snapshot could not be read or
+// the patch could not be written.
+int diffSnapshots(char * olderSnapshot, char * newerSnapshot, char * patchFile)
+{
+	snapshotReader olderReader;
+	snapshotReader newerReader;
+	if(olderReader.open(olderSnapshot) < 1 || newerReader.open(newerSnapshot) < 1)
+		return -1;
+	deltaSource older(olderReader);
+	deltaSource newer(newerReader);
+	return mergeDelta(older, newer, patchFile);
+}
+
+//**************** activityList Class: ********************************
+
+// This function serves as the default constructor for our ADT activitiesList class. The constructor will set the
+// head pointer to the list of activity nodes to null.
+activityList::activityList()
 {
 	head = nullptr; // constructor is working and sets head to null; 
 
@@ -136,14 +1715,20 @@ activityList::activityList()
 // This function serves as the destructor for our ADT activitiesList class. The destructor will release all of
 // the dynamic memory allocated to the activitiesList class.
 activityList::~activityList()
+{
+	removeAll();
+}
+
+// This function will release all of the activities in the list, along with the locations associated with each
+// activity, leaving the list empty.
+int activityList::removeAll()
 {
 	activityNode * temp = nullptr;
-	activityNode * current = head;
 	locationNode * locTemp = nullptr;
-	locationNode * locationCurrent = current -> head;
 	while(head)
 	{
 		// If there are locations at this node, we must deallocate them
+		locationNode * locationCurrent = head -> head;
 		while(locationCurrent)
 		{
 			// Hold the rest of the list of locations
@@ -151,321 +1736,1031 @@ activityList::~activityList()
 			// Deallocate location dynamic memory
 			delete[] locationCurrent -> name;
 			delete[] locationCurrent -> description;
-			delete[] locationCurrent -> reservation;
-			locationCurrent -> numParkingSpots = 0;
+			delete[] locationCurrent -> reservationDetail;
+			delete locationCurrent;
 			// Re-link list of locations
 			locationCurrent = locTemp;
 		}
-		temp = head -> next; // Save the rest of the list
-		delete head; // Deallocate head
-		head = temp; // Move head up to next node
+		temp = head -> next; // Save the rest of the list
+		delete head; // Deallocate head
+		head = temp; // Move head up to next node
+	}
+	index.removeAll();
+	locations.removeAll();
+	statistics.reset();
+	return 1;
+}
+
+// This function will allow the client program to add a new activity node to the LLL of activities. The function will
+// take in an activityData class object containing all of the relevant information about the activity as an argument,
+// and will create a new activity node, placing it correctly in the list based on the alphabetical order of the name
+// of the activity. Rather than traversing the list to find where the new node belongs, we add it to the activity
+// index first, which tells us which node it belongs after.
+int activityList::addActivity(activityData & newActivity)
+{
+	// Create a temp node with the data passed in, then we can decide where to place it
+	activityNode * temp = new activityNode;
+	if(!temp)
+		return 0;
+	// Key the new activity under the collation of the list as it is copied
+	temp -> activity.setCollation(index.getCollation());
+	if(!temp -> activity.copyActivity(newActivity))
+	{
+		delete temp;
+		return 0;
+	}
+	temp -> head = nullptr;
+	temp -> next = nullptr;
+	temp -> numLocations = 0;
+	temp -> totalParking = 0;
+
+	// Place the new node in the list, unless the activity already exists in the list
+	if(adoptActivity(temp) < 0)
+	{
+		delete temp;
+		return -1;
+	}
+	return 1;
+}
+
+// This function will place a new activity node into the list. The node is added to the activity index first, which
+// checks that no activity with the same name is already in the list and tells us which node it belongs after. Any
+// locations already linked to the node (such as when it was read from a snapshot or patch) are added to the location
+// table, and the activity and its locations are counted in the totals. Returns 1 on success, or -1 if an activity
+// with the same name is already in the list, in which case the node is left for the caller to release.
+int activityList::adoptActivity(activityNode * newActivity)
+{
+	newActivity -> activity.setCollation(index.getCollation());
+	activityNode * previous = nullptr;
+	if(index.insert(newActivity, previous) < 0)
+		return -1;
+
+	// If the new node should be the first node in the list
+	if(!previous)
+	{
+		newActivity -> next = head;
+		head = newActivity;
+	}
+	// If the new node should go in the middle or end of the list
+	else
+	{
+		newActivity -> next = previous -> next;
+		previous -> next = newActivity;
+	}
+
+	newActivity -> numLocations = 0;
+	newActivity -> totalParking = 0;
+	for(locationNode * current = newActivity -> head; current; current = current -> next)
+		registerLocation(newActivity, current);
+	newActivity -> activity.addCostTo(statistics);
+	return 1;
+}
+
+// This function will check if the name of an activityData object already appears in the list of activities,
+// by counting the activities up to and including that name in the activity index. If a match is
+// found, a 1 will be returned, signaling to the client program that the activity already appears in the list,
+// meaning another activity of that name should not be added to the list.
+bool activityList::checkMatch(activityData & passedActivity)
+{
+	// If the list is empty, there is no way a matching activity can be here
+	if(!head) return 0;
+	// If including the name counts one more activity, a match has been found
+	return index.countBefore(passedActivity, true) > index.countBefore(passedActivity, false);
+}
+
+// This function will allow the client to display the entire list of activities to the user. The function will use
+// a recursive solution to displaying the data contained in the activityData object in each activity node, using
+// the display member function from the activityData class. The function will return 0 if the list is empty, and
+// will return a positive integer if nodes are displayed.
+// Base case: If head is null, there is nothing to display
+// Problem breakdown: We can break down the problem, one node at a time, by passing head -> next in each
+// 		      recursive call
+int activityList::displayAll()
+{
+	// If the list is empty, there is nothing to display
+	if(!head) return 0;
+	/* Iterative solution:
+	activityNode * current = head;
+	while(current)
+	{
+		current -> activity.display();
+		current = current -> next;
+	}
+	return 1; */
+	return displayAll(head);
+	
+}
+
+// This function will serve as the private, recursive portion of the displayAll function. The 
+// function takes in a pointer to an activityNode object, and displays all of the nodes in the 
+// list of activities.
+int activityList::displayAll(activityNode * head)
+{
+	if(!head) return 1;
+	if(!head -> activity.display())
+		return 0;   
+	
+	return displayAll(head -> next);
+
+}
+
+// This function will allow the client program to add a new location to an activity in our list.
+// The function takes in the name of the activity that the user wishes to add a location to, a 
+// description of the activity, the reservation requirements at this location, and the number
+// of parking spots available at the location. It then searches for an existing activity in the
+// list, and if one is found, it allocates the memory for the location data and copies it into a 
+// new locationNode. That node is then placed at the front of the list of locationNodes, and a 1
+// is returned to signal successfully adding the location. If the list of activities is empty, or
+// no matching activities are found, the function returns a 0, indicating that the client program
+// should alert the user that adding the location failed.
+int activityList::addLocation(char * activityName, char * locationName, char passedDescription[], char passedReservation[], int numSpots)
+{
+	// If the list is empty, there is nothing to add a location to
+	if(!head) return 0;
+	// Find if the activity exists in the list- if it does, allocate the memory for the location info and
+	// copy it in
+	activityNode * current = index.find(activityName);
+	if(!current)
+		return 0; // Activity not found
+
+	// Parse the reservation requirements into a policy, and only keep the text if it says more than the policy does
+	unsigned char policy = parseReservation(passedReservation);
+	char standardText[RESERVATION_TEXT_SIZE];
+	formatReservation(policy, standardText, RESERVATION_TEXT_SIZE);
+	char * detail = strcmp(standardText, passedReservation) == 0 ? nullptr : passedReservation;
+	locationNode * newLocation = createLocation(current, locationName, passedDescription, policy, detail, numSpots);
+	// Add the new location to the front of the list of locations
+	newLocation -> next = current -> head;
+	current -> head = newLocation;
+	return 1;
+}
+
+// This function will allocate a new location for the passed activity, copying in the data passed in, and will add
+// it to the location table. The reservation detail may be null, if the reservation requirements are exactly the
+// standard text for the policy. The location is not linked into the activity's list of locations- that is left to
+// the caller. The location is counted in the totals for its activity and for the whole list. Returns the new location.
+locationNode * activityList::createLocation(activityNode * owner, char * locationName, char * passedDescription, unsigned char policy, char * detail, int numSpots)
+{
+	locationNode * newLocation = new locationNode;
+	newLocation -> name = new char[strlen(locationName) + 1];
+	strcpy(newLocation -> name, locationName);
+	newLocation -> description = new char[strlen(passedDescription) + 1];
+	strcpy(newLocation -> description, passedDescription);
+	newLocation -> reservationDetail = nullptr;
+	if(detail)
+	{
+		newLocation -> reservationDetail = new char[strlen(detail) + 1];
+		strcpy(newLocation -> reservationDetail, detail);
+	}
+	newLocation -> reservationPolicy = policy;
+	newLocation -> numParkingSpots = numSpots;
+	newLocation -> next = nullptr;
+	registerLocation(owner, newLocation);
+	return newLocation;
+}
+
+// This function will add a location of the passed activity to the location table, and count it in the totals for the
+// activity and for the whole list.
+void activityList::registerLocation(activityNode * owner, locationNode * location)
+{
+	locations.add(location, owner);
+	++owner -> numLocations;
+	owner -> totalParking += location -> numParkingSpots;
+	statistics.addParking(location -> numParkingSpots);
+}
+
+// This function will remove a location from the location table and deallocate all of its dynamic memory. The
+// location must already have been unlinked from its activity's list of locations (or be about to be discarded
+// along with it). The location stops being counted in the totals for its activity and for the whole list.
+void activityList::releaseLocation(locationNode * location)
+{
+	activityNode * owner = locations.getActivity(location -> slot);
+	if(owner)
+	{
+		--owner -> numLocations;
+		owner -> totalParking -= location -> numParkingSpots;
+		statistics.removeParking(location -> numParkingSpots);
+	}
+	locations.remove(location);
+	delete [] location -> name;
+	delete [] location -> description;
+	delete [] location -> reservationDetail;
+	delete location;
+}
+
+// This function will allow the client program to display all of the locations associated with an
+// activity. The function will take in the name of the activity the user wishes to see locations for,
+// searches the list of activities for a match, and if one is found, displays all of the locations
+// in the list of locationNodes, and returns a 1 signifying success. If the list is empty, or there is
+// no activity in the list with a matching name, a 0 will be returned to signify failure.
+int activityList::displayLocations(char * activityName)
+{
+	// If the list is empty, there is nothing to do
+	if(!head) return 0;
+	activityNode * activityCurrent = index.find(activityName);
+	// If no match has been found, there is nothing to display
+	if(!activityCurrent)
+		return 0;
+	locationNode * locationCurrent = activityCurrent -> head;
+	while(locationCurrent)
+	{
+		displayLocation(cout, locationCurrent);
+		locationCurrent = locationCurrent -> next;
+	}
+	return 1;
+}
+
+// This function will allow the client program to display the reservation requirements
+// for a given activity and location. The function takes in the name of the activity and
+// the name of the location as arguments, then works to find a matching activity in the
+// list. If the list of activities is empty, or the function does not find a matching 
+// activity, the function will return a 0. If the function finds a matching activity, 
+// it then checks for a matching location. If a matching location is found, the function
+// then displays the reservation requirements associated with that location on the stream
+// passed in (the screen, unless another stream is given). If there is
+// not a matching location in the list of locations, a -1 will be returned.
+int activityList::displayReservation(char * activityName, char * locationName, ostream & out)
+{
+	// If the list is empty, there is nothing to display
+	if(!head) return 0;
+	activityNode * activityCurrent = index.find(activityName);
+	// If no matching activities have been found, there is nothing to display
+	if(!activityCurrent)
+		return 0;
+	// If the list of locations is empty, there is nothing to display
+	if(!activityCurrent -> head) return 0;
+	locationNode * locationCurrent = activityCurrent -> head;
+	while(locationCurrent)
+	{
+		if(strcmp(locationCurrent -> name, locationName) == 0) 
+		{
+			out << "Reservation Requirements: ";
+			writeReservation(out, locationCurrent);
+			out << endl;
+			return 1;
+		}
+		locationCurrent = locationCurrent -> next;
+	}
+	// If we reach this point, no matching locations have been found
+	return -1;
+}
+
+
+// This function will allow the client program to remove a paticular activity from the list of
+// activities. The function takes in the name of the activity that the user wishes to remove,
+// searches the list for an activity with the same name, and if one is found, it deletes the node
+// associated with that activity, deallocating all of the dynamic memory associated with the 
+// activity and the list of locations associated with that activity, and returns a 1 to signify
+// that the removal of the activity was successful. If the list of activities is empty, the
+// function returns a 0. If the list of activities is not empty, but no matching activity was 
+// found, the function returns a -1. 
+int activityList::removeActivity(char * activityName)
+{
+	// If the list of activities is empty, there are no locations to remove
+	if(!head) return 0;
+	// Remove the activity from the index, which also finds the node before it in the list
+	activityNode * activityPrevious = nullptr;
+	activityNode * activityCurrent = index.remove(activityName, activityPrevious);
+	// If no matching activity was found, there is nothing to remove
+	if(!activityCurrent)
+		return -1;
+
+	// Deallocate locations
+	if(activityCurrent -> head)
+	{
+		locationNode * locCurrent = activityCurrent -> head;
+		while(locCurrent)
+		{
+			// Hold onto the rest of the locations
+			locationNode * temp = locCurrent -> next;
+			// Deallocate dynamic memory and remove the location from the location table
+			releaseLocation(locCurrent);
+			locCurrent = temp;
+		}
+	}
+	// Reconnect the list around the deleted node
+	if(activityPrevious) // No need to change head
+		activityPrevious -> next = activityCurrent -> next;
+	else // Remove the first node
+		head = activityCurrent -> next;	
+	activityCurrent -> activity.removeCostFrom(statistics);
+	delete activityCurrent;
+	return 1;
+}
+
+int activityList::writeToFile(char * fileName)
+{
+    // Open the file passed by the client function
+    ofstream outFile(fileName);
+    if(!outFile)
+        return -1;
+    return writeToStream(outFile);
+}
+
+// This function will write every activity in the list, along with its locations, to the stream passed in. This is
+// the body of writeToFile, separated out so the list can also be written to other kinds of streams.
+int activityList::writeToStream(ostream & out)
+{
+	activityNode * activityCurrent = head;
+    while(activityCurrent)
+    {
+        // If the stream could not be written to, return an error
+        if(writeActivity(activityCurrent, out) < 0) return -1;
+        activityCurrent = activityCurrent -> next;
+    }
+    return 1;
+}
+
+// This function will write a single activity and the locations associated with it to the stream passed in, in
+// the format used by writeToFile. Returns -1 if the stream could not be written to, or 1 on success.
+int activityList::writeActivity(activityNode * activityCurrent, ostream & outFile)
+{
+    // Write the activity data to the file
+    int writeActivityData = activityCurrent -> activity.write(outFile);
+    // If the file could not be written to by the member function, return an
+    // error
+    if(writeActivityData < 0) return -1;
+    outFile << "\nLocations: \n";
+    // Write the locations associated with this activity to the file
+    locationNode * locationCurrent = activityCurrent -> head;
+    while(locationCurrent)
+    {
+         outFile << "\tLocation Name: " << locationCurrent -> name << '\n'
+                 << "\tLocation Description: " << locationCurrent -> description << '\n'
+                 << "\tReservation Requirements: ";
+         writeReservation(outFile, locationCurrent);
+         outFile << '\n'
+                 << "\tNumber of Parking Spots: " << locationCurrent -> numParkingSpots 
+                 << '\n' << '\n';
+        locationCurrent = locationCurrent -> next;
+    }
+    return outFile ? 1 : -1;
+}
+
+// This function will build a front-coded index of the names of all of the activities in the list, storing
+// blockSize names in each block. Since the list is kept in alphabetical order, the names can be appended to the
+// index as we traverse. Returns 0 if the block size is less than one, or 1 on success.
+int activityList::buildNameIndex(nameBlockIndex & index, int blockSize)
+{
+	if(!index.reset(blockSize))
+		return 0;
+	index.setCollation(getCollation());
+	activityNode * current = head;
+	while(current)
+	{
+		current -> activity.writeName(index);
+		current = current -> next;
+	}
+	return 1;
+}
+
+// This function will write the entire list to a binary snapshot file, which can be read back in by the loadSnapshot
+// function. The snapshot begins with the collation the list is ordered by and the names of all of the activities in a
+// front-coded name index, followed by the
+// rest of the data for each activity in the same order, along with its locations. Returns -1 if the file could not
+// be opened or written to, or 1 on success.
+int activityList::writeSnapshot(char * fileName)
+{
+	ofstream outFile(fileName, ios::binary);
+	if(!outFile)
+		return -1;
+	nameBlockIndex names;
+	buildNameIndex(names, NAME_BLOCK_SIZE);
+	outFile.write(SNAPSHOT_MAGIC, 4);
+	writeInt(outFile, SNAPSHOT_VERSION);
+	writeInt(outFile, getCollation());
+	if(names.write(outFile) < 0)
+		return -1;
+
+	activityNode * activityCurrent = head;
+	while(activityCurrent)
+	{
+		if(activityCurrent -> activity.writeRecord(outFile) < 0)
+			return -1;
+		writeLocations(outFile, activityCurrent -> head, activityCurrent -> numLocations);
+		activityCurrent = activityCurrent -> next;
+	}
+	return outFile ? 1 : -1;
+}
+
+// This function will replace the contents of the list with a snapshot written by the writeSnapshot function. Each
+// activity is placed in the list using the activity index, and the locations of each activity are kept in the order
+// they were written. The list takes on the collation of the snapshot. Returns -1 if the file could not be opened,
+// 0 if the file is not a valid snapshot (in which case the list is left empty), or 1 on success.
+int activityList::loadSnapshot(char * fileName)
+{
+	snapshotReader reader;
+	int opened = reader.open(fileName);
+	if(opened < 1)
+		return opened;
+
+	removeAll();
+	index.setCollation(reader.getCollation());
+	activityNode * temp;
+	while((temp = reader.next()))
+	{
+		// A snapshot cannot hold two activities with the same name
+		if(adoptActivity(temp) < 0)
+		{
+			releaseDetached(temp);
+			removeAll();
+			return 0;
+		}
+	}
+	if(reader.failed())
+	{
+		removeAll();
+		return 0;
+	}
+	return 1;
+}
+
+// This function will return the number of activities in the list, which the activity index keeps track of.
+int activityList::getCount()
+{
+	return index.getCount();
+}
+
+// This function will find the rank of the activity with the passed name- its position in the list, counting from
+// zero. Returns -1 if there is no activity with that name in the list.
+int activityList::rankOf(char * activityName)
+{
+	return index.rankOf(activityName);
+}
+
+// This function will copy the activity at the passed rank in the list into the activityData object passed in,
+// using the activity index to find it without traversing the list. Returns 1 on success, or 0 if the rank is out of
+// range.
+int activityList::seek(int rank, activityData & found)
+{
+	activityNode * current = index.atRank(rank);
+	if(!current)
+		return 0;
+	return found.copyActivity(current -> activity);
+}
+
+// This function will move a cursor to just before the activity at the passed rank, so that the next page displayed
+// starts with that activity. Returns 1 on success, or 0 if the rank is out of range.
+int activityList::seekCursor(activityCursor & cursor, int rank)
+{
+	if(rank < 0 || rank > index.getCount())
+		return 0;
+	cursor.passed = rank;
+	if(rank == 0)
+	{
+		cursor.atStart = true;
+		return 1;
+	}
+	cursor.atStart = false;
+	return cursor.last.copyActivity(index.atRank(rank - 1) -> activity);
+}
+
+// This function will display up to pageSize activities, starting with the first activity that comes after the
+// cursor alphabetically, and will then move the cursor past them. Since the cursor remembers the last activity
+// it passed rather than a position, activities added or removed since the last page do not cause any activity to
+// be skipped or shown twice. Finding the start of the page takes O(log n) time using the activity index, and then
+// we traverse the list from there. Returns the number of activities displayed.
+int activityList::displayPage(activityCursor & cursor, int pageSize, ostream & out)
+{
+	int rank = cursor.atStart ? 0 : index.countBefore(cursor.last, true);
+	activityNode * current = index.atRank(rank);
+	activityNode * lastDisplayed = nullptr;
+	int displayed = 0;
+	while(current && displayed < pageSize)
+	{
+		current -> activity.display(out);
+		lastDisplayed = current;
+		++displayed;
+		current = current -> next;
+	}
+	// Remember the last activity displayed, so the next page starts after it
+	if(lastDisplayed)
+	{
+		cursor.last.copyActivity(lastDisplayed -> activity);
+		cursor.atStart = false;
+	}
+	cursor.passed = rank + displayed;
+	return displayed;
+}
+
+// This function will write the activity with the passed name, along with its locations, to the stream passed in,
+// in the same format as writeToFile. Returns 0 if there is no activity with that name, -1 if the stream could not
+// be written to, or 1 on success.
+int activityList::lookup(char * activityName, ostream & out)
+{
+	activityNode * current = index.find(activityName);
+	if(!current)
+		return 0;
+	return writeActivity(current, out);
+}
+
+// This function will count the locations whose reservation policy and parking match a filter, using the location
+// table rather than visiting every activity's list of locations. A location matches if the flags of its policy
+// selected by policyMask are exactly those in policyValue, and it has at least minSpots parking spots.
+int activityList::countLocations(unsigned char policyMask, unsigned char policyValue, int minSpots)
+{
+	int matches = 0;
+	for(int slot = locations.findNext(0, policyMask, policyValue, minSpots); slot >= 0;
+	    slot = locations.findNext(slot + 1, policyMask, policyValue, minSpots))
+		++matches;
+	return matches;
+}
+
+// This function will display each location whose reservation policy and parking match a filter (in the same way as
+// countLocations), along with the name of the activity it belongs to. Returns the number of locations displayed.
+int activityList::displayLocations(unsigned char policyMask, unsigned char policyValue, int minSpots, ostream & out)
+{
+	int matches = 0;
+	for(int slot = locations.findNext(0, policyMask, policyValue, minSpots); slot >= 0;
+	    slot = locations.findNext(slot + 1, policyMask, policyValue, minSpots))
+	{
+		out << "Activity Name: ";
+		locations.getActivity(slot) -> activity.writeName(out);
+		out << endl;
+		displayLocation(out, locations.getLocation(slot));
+		++matches;
+	}
+	return matches;
+}
+
+// This function will summarize the whole list of activities: how many activities and locations there are, the
+// total parking, and the cheapest, most expensive and average cost along with a histogram of costs. Every one of
+// these is kept up to date as activities and locations are added and removed, so the list is never traversed.
+// Returns 0 if the list is empty (the summary is still filled in, with zeroes), or 1 otherwise.
+int activityList::getSummary(catalogSummary & summary)
+{
+	summary.numActivities = index.getCount();
+	summary.numLocations = locations.getCount();
+	statistics.getSummary(summary);
+	return head ? 1 : 0;
+}
+
+// This function will find the number of locations for the activity with the passed name, and the total number of
+// parking spots across them, which each activity node keeps track of. Returns 1 on success, 0 if the list is empty,
+// or -1 if there is no activity with that name.
+int activityList::getActivitySummary(char * activityName, int & numLocations, long & totalParking)
+{
+	if(!head) return 0;
+	activityNode * found = index.find(activityName);
+	if(!found)
+		return -1;
+	numLocations = found -> numLocations;
+	totalParking = found -> totalParking;
+	return 1;
+}
+
+// This function will write a patch holding the changes that turn this list into the newer list passed in. Applying
+// the patch to this list with the applyPatch function makes it the same as the newer list. Both lists must be ordered
+// by the same collation. Returns the number of changes written, or -1 if the lists are ordered by different
+// collations or the patch could not be written.
+int activityList::writeDelta(activityList & newer, char * patchFile)
+{
+	deltaSource olderSource(*this);
+	deltaSource newerSource(newer);
+	return mergeDelta(olderSource, newerSource, patchFile);
+}
+
+// This function will write a patch holding the changes that turn a snapshot into this list, such as all of the changes
+// made since the snapshot was saved. The snapshot is read one activity at a time as it is compared. Returns the number
+// of changes written, or -1 if the snapshot could not be read, is ordered by a different collation, or the patch could
+// not be written.
+int activityList::writeDeltaSince(char * snapshotFile, char * patchFile)
+{
+	snapshotReader reader;
+	if(reader.open(snapshotFile) < 1)
+		return -1;
+	deltaSource olderSource(reader);
+	deltaSource newerSource(*this);
+	return mergeDelta(olderSource, newerSource, patchFile);
+}
+
+// This struct will order names under a collation, so that names which match under it (such as "Ski Touring" and
+// "ski touring" when case is ignored) are treated as the same key by a map.
+struct collatedLess
+{
+	int collation; // The collation the names are compared under
+	bool operator()(const string & first, const string & second) const
+	{
+		return collateCompare(first.c_str(), second.c_str(), collation) < 0;
+	}
+};
+
+// This function will apply a patch written by writeDelta, writeDeltaSince or diffSnapshots to this list. Each change
+// names the activity it applies to, which is found with the activity index, so applying a patch takes time in
+// proportion to the number of changes rather than the size of the list. The patch must have been made against the
+// same version of the list, ordered by the same collation. The patch is read twice: first to check that every change
+// fits the list, and then to make the changes, so a patch that does not fit (such as one that was already applied)
+// leaves the list as it was. While checking, the kinds of change made to each name are tracked: a name that is added
+// or removed may not appear in any other change, and no name may have two changes of the same kind. Each change can
+// then be checked against the list as it is before the patch, and is sure to still fit when it is made. Returns -1 if
+// the file could not be opened, 0 if it is not a valid patch for this list, or 1 on success.
+int activityList::applyPatch(char * patchFile)
+{
+	ifstream inFile(patchFile, ios::binary);
+	if(!inFile)
+		return -1;
+	char magic[4];
+	int version, collation;
+	inFile.read(magic, 4);
+	if(!inFile || strncmp(magic, PATCH_MAGIC, 4) != 0 || !readInt(inFile, version) || version < 1
+	   || version > PATCH_VERSION || !readInt(inFile, collation) || collation != getCollation())
+		return 0;
+
+	streampos firstChange = inFile.tellg();
+	// The kinds of change seen for each name while checking, one bit for each kind
+	map<string, int, collatedLess> seen(collatedLess{collation});
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		bool apply = pass == 1;
+		inFile.clear();
+		inFile.seekg(firstChange);
+		int applied = 0;
+		int change = inFile.get();
+		while(inFile && change != PATCH_END)
+		{
+			char * name = readString(inFile);
+			if(!name)
+				return 0;
+			int success = 1;
+			if(!apply && change >= PATCH_ADD_ACTIVITY && change <= PATCH_UPDATE_LOCATIONS)
+			{
+				int & kinds = seen[name];
+				int kind = 1 << change;
+				int addOrRemove = 1 << PATCH_ADD_ACTIVITY | 1 << PATCH_REMOVE_ACTIVITY;
+				if((kinds & kind) || (kinds && ((kinds | kind) & addOrRemove)))
+					success = 0;
+				kinds |= kind;
+			}
+			if(success)
+				success = applyChange(inFile, change, name, apply);
+			delete [] name;
+			if(success != 1)
+				return 0;
+			++applied;
+			change = inFile.get();
+		}
+		// The patch ends with the number of changes, so a patch that was cut short is caught
+		int expected;
+		if(!inFile || !readInt(inFile, expected) || expected != applied)
+			return 0;
+	}
+	return 1;
+}
+
+// This function will read the rest of one change to the activity with the passed name from a patch file. If apply is
+// false, the change is only checked to see that it fits the list- for example, that an activity being added is not
+// already in the list. Otherwise the change is made to the list. The applyPatch function makes sure no other change
+// in the patch affects the same activity in a way that conflicts, so checking each change against the list as it is
+// before the patch is applied is enough. Returns 1 on success, or 0 if the change could not be read or does not fit
+// the list.
+int activityList::applyChange(ifstream & inFile, int change, char * name, bool apply)
+{
+	int success = 0;
+	if(change == PATCH_ADD_ACTIVITY)
+	{
+		activityNode * temp = readActivity(inFile, name, getCollation(), SNAPSHOT_VERSION);
+		if(temp && !apply)
+			success = index.find(name) ? 0 : 1;
+		else if(temp && adoptActivity(temp) == 1)
+		{
+			temp = nullptr;
+			success = 1;
+		}
+		releaseDetached(temp);
+	}
+	else if(change == PATCH_REMOVE_ACTIVITY)
+	{
+		if(!apply)
+			success = index.find(name) ? 1 : 0;
+		else
+			success = removeActivity(name) == 1 ? 1 : 0;
+	}
+	else if(change == PATCH_UPDATE_ACTIVITY)
+	{
+		// The name in the change matches the activity under the collation, so the activity keeps its place
+		activityNode * current = index.find(name);
+		activityData updated;
+		updated.setCollation(getCollation());
+		success = readRecord(inFile, name, updated) && current ? 1 : 0;
+		if(success && apply)
+		{
+			current -> activity.removeCostFrom(statistics);
+			current -> activity.copyActivity(updated);
+			current -> activity.addCostTo(statistics);
+		}
+	}
+	else if(change == PATCH_UPDATE_LOCATIONS)
+	{
+		activityNode * current = index.find(name);
+		int numRemoved;
+		locationNode * added = nullptr;
+		success = readInt(inFile, numRemoved) && readLocations(inFile, SNAPSHOT_VERSION, added) && current
+		          && numRemoved >= 0 && numRemoved <= current -> numLocations ? 1 : 0;
+		if(success && apply)
+		{
+			// Remove the locations at the front of the list, then link the new ones in their place
+			for(int i = 0; i < numRemoved; ++i)
+			{
+				locationNode * temp = current -> head;
+				current -> head = temp -> next;
+				releaseLocation(temp);
+			}
+			locationNode * last = nullptr;
+			for(locationNode * location = added; location; location = location -> next)
+			{
+				registerLocation(current, location);
+				last = location;
+			}
+			if(last)
+			{
+				last -> next = current -> head;
+				current -> head = added;
+			}
+			added = nullptr;
+		}
+		releaseChain(added);
 	}
-
+	return success;
 }
 
-// This function will allow the client program to add a new activity node to the LLL of activities. The function will
-// take in an activityData class object containing all of the relevant information about the activity as an argument,
-// and will create a new activity node, placing it correctly in the list based on the alphabetical order of the name
-// of the activity. 
-int activityList::addActivity(activityData & newActivity)
+// This function will change how the names of activities are ordered and matched. Every activity is keyed again under
+// the new collation and the list is re-sorted, using the activity index to place each one. If two activities would
+// have the same name under the new collation (such as "Ski Touring" and "ski touring" when case is ignored), the
+// list is put back the way it was. Returns 1 on success, 0 if the collation is not valid, or -1 if two activities
+// would have the same name.
+int activityList::setCollation(int mode)
 {
-	// Create a temp node with the data passed in, then we can decide where to place it
-	activityNode * temp = new activityNode;
-	if(!temp)
+	if(mode < COLLATE_BINARY || mode > COLLATE_ACCENTS)
 		return 0;
-	temp -> activity.copyActivity(newActivity);
-	temp -> next = nullptr;
+	int oldMode = index.getCollation();
+	if(mode == oldMode)
+		return 1;
+	activityNode * collided = rebuildOrder(head, mode);
+	if(!collided)
+		return 1;
+	// Gather every activity back into one chain, and order them the old way- none of them collided under it
+	activityNode * chain = collided;
+	while(collided -> next)
+		collided = collided -> next;
+	collided -> next = head;
+	rebuildOrder(chain, oldMode);
+	return -1;
+}
 
-	// Check to see if the new activity already exists in the list
-	if(checkMatch(newActivity))
-		return -1;
+int activityList::getCollation()
+{
+	return index.getCollation();
+}
 
-	// If the list is empty or if temp should be the first node in the list
-	if(!head || head -> activity.compareName(temp -> activity) > 0)
+// This function will empty the list and index, then put each activity node in a chain back into them under the passed
+// collation. Each node is keyed again and added to the index, which tells us where it belongs in the list. Nodes that
+// have the same name as a node already placed are left out, and returned as a chain of their own (or null if every
+// node was placed). The locations of each activity stay with its node, so they do not need to be touched.
+activityNode * activityList::rebuildOrder(activityNode * chain, int mode)
+{
+	head = nullptr;
+	index.removeAll();
+	index.setCollation(mode);
+	activityNode * collided = nullptr;
+	while(chain)
 	{
-		temp -> next = head;
-		head = temp;
-	}
-	// If temp should go in the middle or end of the list
-	else
-	{	
-		// Create current and previous pointers to help us traverse
-		activityNode * current = head;
+		activityNode * current = chain;
+		chain = chain -> next;
+		current -> activity.setCollation(mode);
 		activityNode * previous = nullptr;
-
-		// Traverse current and previous while the name of the current object is less than the name of
-		// the temp object
-		while(current && current -> activity.compareName(temp -> activity) < 0)
+		if(index.insert(current, previous) < 0)
+		{
+			current -> next = collided;
+			collided = current;
+		}
+		else if(previous)
 		{
-			previous = current;
-			current = current -> next;
+			current -> next = previous -> next;
+			previous -> next = current;
+		}
+		else
+		{
+			current -> next = head;
+			head = current;
 		}
-		previous -> next = temp;
-		temp -> next = current;   
 	}
-	
-	return 1;
+	return collided;
 }
 
-// This function will check if the name of an activityData object already appears in the list of activities,
-// using the compareName function from the activityData class to check each activity in the list. If a match is
-// found, a 1 will be returned, signaling to the client program that the activity already appears in the list,
-// meaning another activity of that name should not be added to the list.
-bool activityList::checkMatch(activityData & passedActivity)
+// This function will fold a name into its sort key under a collation, returning a new array holding the key. Two
+// names match under the collation exactly when their sort keys are the same, and comparing sort keys with strcmp
+// orders the names the way the collation does.
+char * makeSortKey(const char * passedName, int collation)
 {
-	// If the list is empty, there is no way a matching activity can be here
-	if(!head) return 0;
-	activityNode * current = head;
-	while(current)
-	{
-		// If the compareName function returns 0, a match has been found
-		if(!current -> activity.compareName(passedActivity))
-			return 1;
-		current = current -> next;
-	}
-	// If we get through the list without finding a match, return 0 indicating no match found
-	return 0;
+	char * key = new char[strlen(passedName) + 1];
+	foldCursor cursor = {reinterpret_cast<const unsigned char *>(passedName), 0};
+	int length = 0;
+	while((key[length] = foldNext(cursor, collation)))
+		++length;
+	return key;
 }
 
-// This function will allow the client to display the entire list of activities to the user. The function will use
-// a recursive solution to displaying the data contained in the activityData object in each activity node, using
-// the display member function from the activityData class. The function will return 0 if the list is empty, and
-// will return a positive integer if nodes are displayed.
-// Base case: If head is null, there is nothing to display
-// Problem breakdown: We can break down the problem, one node at a time, by passing head -> next in each
-// 		      recursive call
-int activityList::displayAll()
+// This function will compare two names under a collation, folding both as it goes, so that no sort keys need to
+// be built. Returns a value less than zero if the first name comes first, zero if the names match, or a value greater
+// than zero if the second name comes first.
+int collateCompare(const char * first, const char * second, int collation)
 {
-	// If the list is empty, there is nothing to display
-	if(!head) return 0;
-	/* Iterative solution:
-	activityNode * current = head;
-	while(current)
+	foldCursor firstCursor = {reinterpret_cast<const unsigned char *>(first), 0};
+	foldCursor secondCursor = {reinterpret_cast<const unsigned char *>(second), 0};
+	while(true)
 	{
-		current -> activity.display();
-		current = current -> next;
+		int firstFolded = foldNext(firstCursor, collation);
+		int secondFolded = foldNext(secondCursor, collation);
+		if(firstFolded != secondFolded || !firstFolded)
+			return firstFolded - secondFolded;
 	}
-	return 1; */
-	return displayAll(head);
-	
 }
 
-// This function will serve as the private, recursive portion of the displayAll function. The 
-// function takes in a pointer to an activityNode object, and displays all of the nodes in the 
-// list of activities.
-int activityList::displayAll(activityNode * head)
+// This function will hash a name using the FNV-1a hash function, which is quick to compute and spreads similar
+// names (such as names sharing a long prefix) evenly across the range of values. The name is folded under the
+// collation as it is hashed, so that it hashes to the same value as its sort key.
+unsigned int hashName(const char * passedName, int collation)
 {
-	if(!head) return 1;
-	if(!head -> activity.display())
-		return 0;   
-	
-	return displayAll(head -> next);
-
+	unsigned int hash = 2166136261u;
+	foldCursor cursor = {reinterpret_cast<const unsigned char *>(passedName), 0};
+	int folded;
+	while((folded = foldNext(cursor, collation)))
+	{
+		hash ^= static_cast<unsigned char>(folded);
+		hash *= 16777619u;
+	}
+	return hash;
 }
 
-// This function will allow the client program to add a new location to an activity in our list.
-// The function takes in the name of the activity that the user wishes to add a location to, a 
-// description of the activity, the reservation requirements at this location, and the number
-// of parking spots available at the location. It then searches for an existing activity in the
-// list, and if one is found, it allocates the memory for the location data and copies it into a 
-// new locationNode. That node is then placed at the front of the list of locationNodes, and a 1
-// is returned to signal successfully adding the location. If the list of activities is empty, or
-// no matching activities are found, the function returns a 0, indicating that the client program
-// should alert the user that adding the location failed.
-int activityList::addLocation(char * activityName, char * locationName, char passedDescription[], char passedReservation[], int numSpots)
+// This function will display the data for a single location, as shown when displaying the locations of an activity.
+void displayLocation(ostream & out, locationNode * location)
 {
-	// If the list is empty, there is nothing to add a location to
-	if(!head) return 0;
-	activityNode * current = head;
-	// Find if the activity exists in the list- if it does, allocate the memory for the location info and
-	// copy it in
-	while(current)
-	{
-		// If the name of current matches the passed name, load the location data
-		if(current -> activity.isMatch(activityName))
-		{
-		//	cout << "Match has been found" << endl; // FOR TESTING-REMOVE WHEN POSSIBLE
-			locationNode * newLocation = new locationNode;
-			newLocation -> name = new char[strlen(locationName) + 1];
-			strcpy(newLocation -> name, locationName);
-			newLocation -> description = new char[strlen(passedDescription) + 1];
-			strcpy(newLocation -> description, passedDescription);
-			newLocation -> reservation = new char[strlen(passedReservation) + 1];
-			strcpy(newLocation -> reservation, passedReservation);
-			newLocation -> numParkingSpots = numSpots;
-			// Add the new location to the front of the list of locations
-			newLocation -> next = current -> head;
-			current -> head = newLocation;
-			return 1;
-		}
-		current = current -> next;
-	}
-//	cout << "No match found" << endl; // FOR TESTING- REMOVE WHEN POSSIBLE
-	return 0; // Activity not found
+	out << "Location Name: " << location -> name << endl 
+	    << "Location Description: " << location -> description << endl
+	    << "Reservation Requirements: ";
+	writeReservation(out, location);
+	out << endl << "Number of Parking Spots: " << location -> numParkingSpots 
+	    << endl << endl;
 }
 
-// This function will allow the client program to display all of the locations associated with an
-// activity. The function will take in the name of the activity the user wishes to see locations for,
-// searches the list of activities for a match, and if one is found, displays all of the locations
-// in the list of locationNodes, and returns a 1 signifying success. If the list is empty, or there is
-// no activity in the list with a matching name, a 0 will be returned to signify failure.
-int activityList::displayLocations(char * activityName)
+// This function will parse the reservation requirements entered by the user into a reservation policy, by looking
+// for common words (ignoring case). The text is split into whole words, so "coffee" does not count as "fee", and into
+// clauses, which end at punctuation or the word "but". A clause with "no", "not" or "without" in it is negated, and
+// none of the words in a negated clause add to the policy- "no permit needed" and "permit not needed" mean no permit
+// is needed. Answers like "no", "none", "not required", "walk-in" or "first come, first served" mean no reservations
+// are needed, while "yes" or "required" mean they are required. "Needed" and "must" only mean reservations are
+// required when the text is about reserving or booking ("reservations needed", "must book ahead"), since they are
+// just as often about something else ("Sno-Park pass needed"). Other words add more detail to the policy, such as
+// "weekends", "groups", "permit" or "fee", and "unknown" marks the policy as not understood, so the text
+// formatReservation writes for any policy parses back to that policy. If none of the words are found, the policy is
+// RESERVATION_UNKNOWN.
+unsigned char parseReservation(const char * text)
 {
-	// If the list is empty, there is nothing to do
-	if(!head) return 0;
-	activityNode * activityCurrent = head;
-	while(activityCurrent)
+	if(!text)
+		return RESERVATION_UNKNOWN;
+	// Make a lowercase copy so we can search it without worrying about case
+	int length = strlen(text);
+	char * lower = new char[length + 1];
+	for(int i = 0; i <= length; ++i)
+		lower[i] = tolower(static_cast<unsigned char>(text[i]));
+	// Split the copy into words, remembering where each one starts, how long it is, and which clause it is in. A
+	// dollar sign counts as a word of its own.
+	const char ** words = new const char * [length + 1];
+	int * wordLength = new int[length + 1];
+	int * clauseOf = new int[length + 1];
+	int numWords = 0;
+	int numClauses = 1;
+	int position = 0;
+	while(position < length)
 	{
-		if(activityCurrent -> activity.isMatch(activityName))
+		int start = position;
+		if(lower[position] == '$')
+			++position;
+		else
+			while(position < length && (isalnum(static_cast<unsigned char>(lower[position])) || lower[position] == '\''
+			      || static_cast<unsigned char>(lower[position]) >= 0x80))
+				++position;
+		if(position == start)
 		{
-//			cout << "Matching activity found" << endl; // FOR TESTING, REMOVE WHEN POSSIBLE
-			locationNode * locationCurrent = activityCurrent -> head;
-			while(locationCurrent)
-			{
-				cout << "Location Name: " << locationCurrent -> name << endl 
-				     << "Location Description: " << locationCurrent -> description << endl
-			     	 << "Reservation Requirements: " << locationCurrent -> reservation << endl
-		     	     << "Number of Parking Spots: " << locationCurrent -> numParkingSpots 
-				     << endl << endl;
-				locationCurrent = locationCurrent -> next;
-			}
-			return 1;
+			if(strchr(",.;:!?()", lower[position]))
+				++numClauses;
+			++position;
+		}
+		else if(position - start == 3 && strncmp(lower + start, "but", 3) == 0)
+			++numClauses;
+		else
+		{
+			words[numWords] = lower + start;
+			wordLength[numWords] = position - start;
+			clauseOf[numWords] = numClauses - 1;
+			++numWords;
 		}
-		activityCurrent = activityCurrent -> next;
 	}
-	// If we have gotten this far, no match has been found
-//	cout << "No match found" << endl; // FOR TESTING- REMOVE WHEN POSSIBLE
-	return 0;
-}
+	// Whether the word at this index is exactly the passed word, or starts with the passed stem
+	auto is = [&](int index, const char * word)
+	{
+		return index < numWords && wordLength[index] == static_cast<int>(strlen(word))
+		       && strncmp(words[index], word, wordLength[index]) == 0;
+	};
+	auto startsWith = [&](int index, const char * stem)
+	{
+		int stemLength = strlen(stem);
+		return index < numWords && wordLength[index] >= stemLength && strncmp(words[index], stem, stemLength) == 0;
+	};
+	bool * negated = new bool[numClauses];
+	for(int i = 0; i < numClauses; ++i)
+		negated[i] = false;
+	for(int i = 0; i < numWords; ++i)
+		if(is(i, "no") || is(i, "not") || is(i, "without"))
+			negated[clauseOf[i]] = true;
 
-// This function will allow the client program to display the reservation requirements
-// for a given activity and location. The function takes in the name of the activity and
-// the name of the location as arguments, then works to find a matching activity in the
-// list. If the list of activities is empty, or the function does not find a matching 
-// activity, the function will return a 0. If the function finds a matching activity, 
-// it then checks for a matching location. If a matching location is found, the function
-// then displays the reservation requirements associated with that location. If there is
-// not a matching location in the list of locations, a -1 will be returned.
-int activityList::displayReservation(char * activityName, char * locationName)
-{
-	// If the list is empty, there is nothing to display
-	if(!head) return 0;
-	activityNode * activityCurrent = head;
-	while(activityCurrent)
+	unsigned char policy = RESERVATION_NONE;
+	bool understood = false;
+	bool needed = false;
+	bool aboutReserving = false;
+	for(int i = 0; i < numWords; ++i)
 	{
-		if(activityCurrent -> activity.isMatch(activityName))
+		bool reservingWord = startsWith(i, "reserv") || startsWith(i, "book");
+		bool requiringWord = startsWith(i, "require") || is(i, "needed") || is(i, "must");
+		if(negated[clauseOf[i]])
 		{
-			// If the list of locations is empty, there is nothing to display
-			if(!activityCurrent -> head) return 0;
-			locationNode * locationCurrent = activityCurrent -> head;
-			while(locationCurrent)
-			{
-				if(strcmp(locationCurrent -> name, locationName) == 0) 
-				{
-					cout << "Reservation Requirements: " 
-					     << locationCurrent -> reservation << endl;
-					return 1;
-				}
-				locationCurrent = locationCurrent -> next;
-			}
-			// If we reach this point, no matching locations have been found
-			return -1;
+			// "No", "not required", "no reservations" and the like all say that no reservations are needed
+			if(i == 0 || reservingWord || requiringWord)
+				understood = true;
+			continue;
 		}
-		activityCurrent = activityCurrent -> next;
+		if(is(i, "none") || (is(i, "walk") && (is(i + 1, "in") || is(i + 1, "ins")))
+		   || (is(i, "first") && startsWith(i + 1, "come")))
+			understood = true;
+		if((i == 0 && is(i, "yes")) || startsWith(i, "require"))
+			policy |= RESERVATION_REQUIRED;
+		if(is(i, "needed") || is(i, "must"))
+			needed = true;
+		if(reservingWord)
+			aboutReserving = true;
+		if(startsWith(i, "recommend") || startsWith(i, "suggest") || startsWith(i, "advise"))
+			policy |= RESERVATION_RECOMMENDED;
+		if(startsWith(i, "weekend") || startsWith(i, "holiday"))
+			policy |= RESERVATION_WEEKENDS;
+		if(startsWith(i, "group"))
+			policy |= RESERVATION_GROUPS;
+		if(is(i, "permit") || is(i, "permits") || is(i, "pass") || is(i, "passes"))
+			policy |= RESERVATION_PERMIT;
+		if(is(i, "fee") || is(i, "fees") || is(i, "$"))
+			policy |= RESERVATION_FEE;
+		if(is(i, "unknown"))
+			policy |= RESERVATION_UNKNOWN;
 	}
-	// If we reach this point, no matching activities have been found
-	return 0;
+	if(needed && aboutReserving)
+		policy |= RESERVATION_REQUIRED;
+	delete [] lower;
+	delete [] words;
+	delete [] wordLength;
+	delete [] clauseOf;
+	delete [] negated;
+	if(!understood && policy == RESERVATION_NONE)
+		return RESERVATION_UNKNOWN;
+	return policy;
 }
 
-
-// This function will allow the client program to remove a paticular activity from the list of
-// activities. The function takes in the name of the activity that the user wishes to remove,
-// searches the list for an activity with the same name, and if one is found, it deletes the node
-// associated with that activity, deallocating all of the dynamic memory associated with the 
-// activity and the list of locations associated with that activity, and returns a 1 to signify
-// that the removal of the activity was successful. If the list of activities is empty, the
-// function returns a 0. If the list of activities is not empty, but no matching activity was 
-// found, the function returns a -1. 
-int activityList::removeActivity(char * activityName)
+// This function will write the standard text for a reservation policy into the buffer passed in: "None" if no
+// reservations are needed, or otherwise a description of each flag in the policy, separated by commas. A buffer of
+// RESERVATION_TEXT_SIZE chars can hold the text for any policy. Returns 0 if the buffer is too small, or 1 on success.
+int formatReservation(unsigned char policy, char buffer[], int size)
 {
-	// If the list of activities is empty, there are no locations to remove
-	if(!head) return 0;
-	activityNode * activityCurrent = head;
-	activityNode * activityPrevious = nullptr;
-	while(activityCurrent)
-	{
-		// If a matching activity is found, deallocate all dynamic memory associated
-		if(activityCurrent -> activity.isMatch(activityName))
+	const unsigned char flags[] = {RESERVATION_REQUIRED, RESERVATION_RECOMMENDED, RESERVATION_WEEKENDS,
+	                               RESERVATION_GROUPS, RESERVATION_PERMIT, RESERVATION_FEE, RESERVATION_UNKNOWN};
+	const char * labels[] = {"Required", "Recommended", "Weekends only", "Groups only", "Permit needed",
+	                         "Fee charged", "Unknown"};
+	if(size < 1)
+		return 0;
+	buffer[0] = '\0';
+	if(policy == RESERVATION_NONE)
+		return snprintf(buffer, size, "None") < size;
+	int used = 0;
+	for(int i = 0; i < 7; ++i)
+		if(policy & flags[i])
 		{
-			// Deallocate locations
-			if(activityCurrent -> head)
-			{
-				locationNode * locCurrent = activityCurrent -> head;
-				while(locCurrent)
-				{
-					// Hold onto the rest of the locations
-					locationNode * temp = locCurrent -> next;
-					// Deallocate dynamic memory
-					if(locCurrent -> name)
-						delete [] locCurrent -> name;
-					if(locCurrent -> description)
-						delete [] locCurrent -> description;
-					if(locCurrent -> reservation)
-						delete [] locCurrent -> reservation;
-					locCurrent -> name = nullptr;
-					locCurrent -> description = nullptr;
-					locCurrent -> reservation = nullptr;
-					locCurrent -> numParkingSpots = 0;
-					delete locCurrent;
-					locCurrent = temp;
-				}
-			}
-			if(activityPrevious) // No need to change head
-				activityPrevious -> next = activityCurrent -> next;
-			else // Remove the first node
-				head = activityCurrent -> next;	
-			delete activityCurrent;
-			// Reconnect the list around the deleted node
-			return 1;
+			int written = snprintf(buffer + used, size - used, "%s%s", used ? ", " : "", labels[i]);
+			if(written >= size - used)
+				return 0;
+			used += written;
 		}
-		// Traverse current and previous
-		activityPrevious = activityCurrent;
-		activityCurrent = activityCurrent -> next;
-	}
-	// If we have reached this point, no matching activity is in the list
-	return -1;
+	return 1;
 }
 
-int activityList::writeToFile(char * fileName)
+// This function will write the reservation requirements of a location exactly as they were entered: the stored
+// detail if there is one, or otherwise the standard text for the location's policy (which is what was entered).
+void writeReservation(ostream & out, locationNode * location)
 {
-    // Open the file passed by the client function
-    ofstream outFile(fileName);
-    if(!outFile)
-        return -1;
-
-	activityNode * activityCurrent = head;
-    while(activityCurrent)
-    {
-        // Write the activity data to the file
-        int writeActivityData = activityCurrent -> activity.write(outFile);
-        // If the file could not be written to by the member function, return an
-        // error
-        if(!writeActivityData) return -1;
-        outFile << "\nLocations: \n";
-        // Write the locations associated with this activity to the file
-        locationNode * locationCurrent = activityCurrent -> head;
-        while(locationCurrent)
-        {
-             outFile << "\tLocation Name: " << locationCurrent -> name << '\n'
-                     << "\tLocation Description: " << locationCurrent -> description << '\n'
-                     << "\tReservation Requirements: " << locationCurrent -> reservation << '\n'
-                     << "\tNumber of Parking Spots: " << locationCurrent -> numParkingSpots 
-                     << '\n' << '\n';
-            locationCurrent = locationCurrent -> next;
-        }
-        activityCurrent = activityCurrent -> next;
-    }
-    return 1;
+	if(location -> reservationDetail)
+	{
+		out << location -> reservationDetail;
+		return;
+	}
+	char standardText[RESERVATION_TEXT_SIZE];
+	formatReservation(location -> reservationPolicy, standardText, RESERVATION_TEXT_SIZE);
+	out << standardText;
 }
 
 // Client program functions:
@@ -567,6 +2862,202 @@ void exportToFile(activityList & myList)
         cout << "Activities saved to " << fileName << " successfully!" << endl;
 }
 
+// This function will get the name of the file that the user would like to save a snapshot to, and will pass it to
+// the activityList class writeSnapshot function. Unlike exportToFile, the snapshot can be loaded back in later.
+void exportSnapshot(activityList & myList)
+{
+	char fileName[50];
+	cout << "Enter the name of the file you wish to save a snapshot of your activities to: ";
+	cin.get(fileName, 50, '\n');
+	cin.ignore(100, '\n');
+	if(myList.writeSnapshot(fileName) < 0)
+		cout << "Error saving snapshot- could not write to file" << endl;
+	else
+		cout << "Snapshot saved to " << fileName << " successfully!" << endl;
+}
+
+// This function will get the name of a snapshot file from the user, and will pass it to the activityList class
+// loadSnapshot function to replace the current list of activities with the activities in the snapshot.
+void importSnapshot(activityList & myList)
+{
+	char fileName[50];
+	cout << "Enter the name of the snapshot file you wish to load your activities from: ";
+	cin.get(fileName, 50, '\n');
+	cin.ignore(100, '\n');
+	int success = myList.loadSnapshot(fileName);
+	if(success < 0)
+		cout << "Error loading snapshot- could not open file" << endl;
+	else if(!success)
+		cout << "Error loading snapshot- file is not a valid snapshot" << endl;
+	else
+		cout << "Activities loaded from " << fileName << " successfully!" << endl;
+}
+
+// This function will allow the user to page through the list of activities a few at a time. The user picks the
+// activity to start from and the number of activities per page, and then each page is displayed using a cursor.
+void browseActivities(activityList & myList)
+{
+	int start, pageSize;
+	cout << "There are " << myList.getCount() << " activities. Please enter the number of the activity to start from:"
+	     << endl;
+	cin >> start;
+	cin.ignore(100, '\n');
+	cout << "Please enter the number of activities to display on each page:" << endl;
+	cin >> pageSize;
+	cin.ignore(100, '\n');
+
+	activityCursor cursor;
+	if(pageSize < 1 || !myList.seekCursor(cursor, start - 1))
+	{
+		cout << "Error browsing activities- no activity with that number" << endl;
+		return;
+	}
+	char response {'Y'};
+	while(toupper(response) == 'Y')
+	{
+		int first = cursor.getPassed() + 1;
+		int displayed = myList.displayPage(cursor, pageSize);
+		if(!displayed)
+		{
+			cout << "No more activities to display" << endl;
+			return;
+		}
+		cout << "Displayed activities " << first << " to " << cursor.getPassed() << " of " << myList.getCount()
+		     << endl << "Would you like to see the next page? Enter Y for yes or N for no" << endl;
+		cin >> response;
+		cin.ignore(100, '\n');
+	}
+}
+
+// This function will allow the user to find locations by their reservation requirements and parking. The user
+// picks one of a few common reservation filters and the least number of parking spots they need, and every matching
+// location is displayed along with the name of its activity.
+void filterLocations(activityList & myList)
+{
+	int choice, minSpots;
+	cout << "Which locations would you like to find?" << endl
+	     << "1: Locations that do not require reservations" << endl
+	     << "2: Locations that require reservations" << endl
+	     << "3: Locations that recommend reservations" << endl
+	     << "4: Locations that need a permit or pass" << endl
+	     << "5: All locations" << endl;
+	cin >> choice;
+	cin.ignore(100, '\n');
+	cout << "Please enter the least number of parking spots the location should have:" << endl;
+	cin >> minSpots;
+	cin.ignore(100, '\n');
+
+	// Each choice selects some flags of the reservation policy, and the values those flags must have
+	unsigned char masks[] = {RESERVATION_REQUIRED | RESERVATION_UNKNOWN, RESERVATION_REQUIRED, RESERVATION_RECOMMENDED,
+	                         RESERVATION_PERMIT, 0};
+	unsigned char values[] = {0, RESERVATION_REQUIRED, RESERVATION_RECOMMENDED, RESERVATION_PERMIT, 0};
+	if(choice < 1 || choice > 5)
+	{
+		cout << "Error- not a valid choice" << endl;
+		return;
+	}
+	int found = myList.displayLocations(masks[choice - 1], values[choice - 1], minSpots);
+	if(found)
+		cout << found << " matching locations found" << endl;
+	else
+		cout << "No matching locations found" << endl;
+}
+
+// This function will display a summary of the whole list of activities, followed by a summary of a single activity
+// if the user asks for one.
+void displaySummary(activityList & myList)
+{
+	const char * bucketNames[COST_BUCKETS] = {"Free", "Under $10", "$10 to $25", "$25 to $50", "$50 to $100",
+	                                          "$100 to $200", "$200 or more"};
+	catalogSummary summary;
+	if(!myList.getSummary(summary))
+	{
+		cout << "Error displaying summary- no activities currently saved" << endl;
+		return;
+	}
+	cout << "Activities: " << summary.numActivities << endl
+	     << "Locations: " << summary.numLocations << endl
+	     << "Parking Spots: " << summary.totalParking << endl
+	     << "Cheapest Activity Cost: " << summary.minCost << endl
+	     << "Most Expensive Activity Cost: " << summary.maxCost << endl
+	     << "Average Activity Cost: " << summary.averageCost << endl
+	     << "Activities by Cost:" << endl;
+	for(int i = 0; i < COST_BUCKETS; ++i)
+		cout << "    " << bucketNames[i] << ": " << summary.costHistogram[i] << endl;
+
+	char activityName[100];
+	cout << "Please enter the name of an activity to summarize, or press enter to skip:" << endl;
+	cin.get(activityName, 100, '\n');
+	cin.clear();
+	cin.ignore(100, '\n');
+	if(!activityName[0])
+		return;
+	int numLocations = 0;
+	long totalParking = 0;
+	if(myList.getActivitySummary(activityName, numLocations, totalParking) < 1)
+		cout << "Error- no matching activity found" << endl;
+	else
+		cout << "Locations: " << numLocations << endl
+		     << "Parking Spots: " << totalParking << endl;
+}
+
+// This function will let the user change how the names of activities are ordered and matched.
+void changeCollation(activityList & myList)
+{
+	const char * collationNames[] = {"Exact (uppercase, lowercase and accents all matter)", "Ignore uppercase and lowercase",
+	                                 "Ignore uppercase, lowercase and accents"};
+	int choice;
+	cout << "Names are currently ordered by: " << collationNames[myList.getCollation()] << endl
+	     << "How would you like names to be ordered and matched?" << endl;
+	for(int i = COLLATE_BINARY; i <= COLLATE_ACCENTS; ++i)
+		cout << i + 1 << ": " << collationNames[i] << endl;
+	cin >> choice;
+	cin.ignore(100, '\n');
+	int success = myList.setCollation(choice - 1);
+	if(!success)
+		cout << "Error- not a valid choice" << endl;
+	else if(success < 0)
+		cout << "Error- two activities would have the same name, so the order was not changed" << endl;
+	else
+		cout << "Names are now ordered by: " << collationNames[choice - 1] << endl;
+}
+
+// This function will get the name of a snapshot file and a patch file from the user, and will save the changes made
+// to the list since the snapshot was saved to the patch file, using the activityList class writeDeltaSince function.
+void exportPatch(activityList & myList)
+{
+	char snapshotFile[50];
+	char patchFile[50];
+	cout << "Enter the name of the snapshot file to compare your activities with: ";
+	cin.get(snapshotFile, 50, '\n');
+	cin.ignore(100, '\n');
+	cout << "Enter the name of the file you wish to save the changes to: ";
+	cin.get(patchFile, 50, '\n');
+	cin.ignore(100, '\n');
+	int changes = myList.writeDeltaSince(snapshotFile, patchFile);
+	if(changes < 0)
+		cout << "Error saving changes- could not read the snapshot or write to the file" << endl;
+	else
+		cout << changes << " changes saved to " << patchFile << " successfully!" << endl;
+}
+
+// This function will get the name of a patch file from the user, and will pass it to the activityList class
+// applyPatch function to make the changes in the patch to the list of activities.
+void importPatch(activityList & myList)
+{
+	char fileName[50];
+	cout << "Enter the name of the file you wish to load changes from: ";
+	cin.get(fileName, 50, '\n');
+	cin.ignore(100, '\n');
+	int success = myList.applyPatch(fileName);
+	if(success < 0)
+		cout << "Error loading changes- could not open file" << endl;
+	else if(!success)
+		cout << "Error loading changes- file is not a valid patch for these activities" << endl;
+	else
+		cout << "Changes loaded from " << fileName << " successfully!" << endl;
+}
+
 // Menu Functions:
 
 // This client function will serve to display the menu of options to the user, allowing them to view the 
@@ -581,7 +3072,15 @@ void displayMenu()
 	     << "5: Display reservation requirements for an activity/location:" << endl 
 	     << "6: Remove an activity from the list:" << endl
 	     << "7: Export Activities to File:" << endl
-	     << "8: Quit:" << endl;
+	     << "8: Save Snapshot of Activities:" << endl
+	     << "9: Load Snapshot of Activities:" << endl
+	     << "10: Browse Activities a Page at a Time:" << endl
+	     << "11: Find Locations by Reservations and Parking:" << endl
+	     << "12: Display Catalog Summary:" << endl
+	     << "13: Change How Names Are Ordered:" << endl
+	     << "14: Save Changes Since a Snapshot:" << endl
+	     << "15: Load Changes:" << endl
+	     << "16: Quit:" << endl;
 }
 
 // This client function will serve as the control for the main menu. The function takes in the list by reference, and
@@ -676,13 +3175,53 @@ void mainMenu(activityList & myList)
             exportToFile(myList);
         }
             break;
-		case 8: 
+		case 8:
+		{
+			exportSnapshot(myList);
+		}
+			break;
+		case 9:
+		{
+			importSnapshot(myList);
+		}
+			break;
+		case 10:
+		{
+			browseActivities(myList);
+		}
+			break;
+		case 11:
+		{
+			filterLocations(myList);
+		}
+			break;
+		case 12:
+		{
+			displaySummary(myList);
+		}
+			break;
+		case 13:
+		{
+			changeCollation(myList);
+		}
+			break;
+		case 14:
+		{
+			exportPatch(myList);
+		}
+			break;
+		case 15:
+		{
+			importPatch(myList);
+		}
+			break;
+		case 16: 
 		{
 			cout << "Goodbye, see you next time!" << endl;
 		}
 		
 	}		
-	if(menuSelection != 8)
+	if(menuSelection != 16)
 	{
 		char response;
 		cout << "Would you like to return to the main menu? Enter Y for yes or N for no" << endl;
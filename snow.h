@@ -10,14 +10,135 @@
  program. 
  */
 
+#ifndef SNOW_H
+#define SNOW_H
+
 #include <iostream>
 #include <cctype>
 #include <cstring>
 #include <fstream>
+#include <set>
 
 using namespace std;
 // Struct / class interfaces:
 
+// The ways the names of activities can be ordered and matched. Under COLLATE_BINARY names are compared byte by byte,
+// so "Ski Touring" and "ski touring" are two different activities. Under COLLATE_CASE uppercase and lowercase
+// letters are treated the same, and under COLLATE_ACCENTS accented Latin letters (such as the e in "Telemark
+// Ski Cafe" with an accent) are also treated the same as the plain letters.
+enum collationMode
+{
+	COLLATE_BINARY = 0, // Names are compared byte by byte
+	COLLATE_CASE = 1, // Case is ignored
+	COLLATE_ACCENTS = 2 // Case and accents are ignored
+};
+
+// The collation new lists of activities start out with
+const int DEFAULT_COLLATION = COLLATE_CASE;
+
+// The number of buckets in the histogram of activity costs kept by the catalogStatistics class
+const int COST_BUCKETS = 7;
+
+// This struct will hold a summary of the whole list of activities, as reported by the getSummary function of the
+// activityList class.
+struct catalogSummary
+{
+	int numActivities; // The number of activities in the list
+	int numLocations; // The number of locations across all of the activities
+	long totalParking; // The number of parking spots across all of the locations
+	float minCost; // The cost of the cheapest activity (0 if there are no activities)
+	float maxCost; // The cost of the most expensive activity (0 if there are no activities)
+	float averageCost; // The average cost of the activities (0 if there are no activities)
+	int costHistogram[COST_BUCKETS]; // The number of activities with a cost in each bucket
+};
+
+// This class will keep running totals for the activities and locations in a list, updated as each activity or
+// location is added or removed, so that a summary of the whole list never needs to traverse it. Every cost is kept
+// in an ordered multiset, so the cheapest and most expensive costs stay correct when activities are removed, and
+// each cost is counted in one bucket of a histogram: free, under $10, $25, $50, $100, $200, and $200 or more.
+class catalogStatistics
+{
+	public:
+		catalogStatistics();
+		// Count the cost of an activity that was added to the list
+		int addCost(float cost);
+		// Stop counting the cost of an activity that was removed from the list
+		int removeCost(float cost);
+		// Count the parking spots of a location that was added to the list
+		int addParking(int numSpots);
+		// Stop counting the parking spots of a location that was removed from the list
+		int removeParking(int numSpots);
+		// Fill in the cost and parking fields of a summary
+		int getSummary(catalogSummary & summary);
+		// Forget every activity and location counted so far
+		int reset();
+		// The bucket of the cost histogram a cost is counted in
+		static int bucketOf(float cost);
+
+	private:
+		multiset<float> costs; // The cost of each activity, in order
+		double totalCost; // The sum of the costs of the activities
+		int costHistogram[COST_BUCKETS]; // The number of activities with a cost in each bucket
+		long totalParking; // The number of parking spots across all of the locations
+};
+
+// This class will hold the names of the activities in front-coded (prefix-compressed) form. Since the list of 
+// activities is kept in alphabetical order, neighboring names tend to share long prefixes. The names are stored in
+// blocks of blockSize names: the first name in each block (the block head) is stored in full, and every name after it
+// is stored as the number of leading characters it shares with the name before it, followed by the rest of the name.
+// The block heads can be compared directly, so a lookup is a binary search over the block heads followed by a short
+// scan through a single block.
+// Only snapshots are front-coded: the index is built when a snapshot is written, and read back when a snapshot is
+// loaded, compared, or searched for a name without loading it. The activities in a live list keep their names (and
+// sort keys) as plain strings.
+class nameBlockIndex
+{
+	public:
+		nameBlockIndex();
+		~nameBlockIndex();
+		// Release all names and set the number of names stored per block
+		int reset(int passedBlockSize);
+		// Set the collation the names in the index are sorted by
+		int setCollation(int mode);
+		// Append a name to the index- names must be appended in sorted order
+		int addName(char * passedName);
+		// Find the position of a name in the index, or -1 if it is not found
+		int find(char * passedName);
+		// Copy the name at a position in the index into a buffer
+		int getName(int position, char buffer[], int size);
+		// The number of names in the index
+		int getCount();
+		// The length of the longest name in the index
+		int getLongest();
+		// Write the index to a binary snapshot file
+		int write(ofstream & outFile);
+		// Read the index from a binary snapshot file
+		int read(ifstream & inFile);
+
+	private:
+		char * bytes; // The front-coded names
+		int byteCount; // The number of bytes of names stored
+		int byteCapacity; // The number of bytes allocated for names
+		int * blockOffsets; // The offset of the head of each block in bytes
+		int blockCount; // The number of blocks stored
+		int blockCapacity; // The number of block offsets allocated
+		int blockSize; // The number of names stored in each block
+		int count; // The number of names stored
+		int longest; // The length of the longest name stored
+		char * lastName; // The last name appended to the index
+		char * scratch; // Buffer used to decode names during a lookup
+		int nameCapacity; // The number of chars allocated for lastName and scratch
+		int collation; // The collation the names are sorted by, used to search for a name
+		// Make room for more bytes of names
+		int reserveBytes(int needed);
+		// Make room for lastName and scratch to hold a name of this length
+		int reserveNames(int length);
+		// Decode the name at a position in the index into a buffer
+		void decode(int position, char buffer[]);
+		// Check that the names read from a snapshot decode safely
+		int validate(int passedCount, int passedBlockCount, int passedByteCount, int passedLongest);
+};
+
 // This class will combine all of the data necessary for each snow activity into one passable package.
 // Each node in the LLL of snow activities will contain one of these class objects to hold the relevant data for the
 // activity. 
@@ -31,31 +152,82 @@ class activityData
 		// Load activity from another activityData object:
 		int copyActivity(activityData & passedActivity);
 		// Display activity data:
-		int display();
+		int display(ostream & out = cout);
 		// Determine if a name matches the name of an activity:
 		bool isMatch(char * passedName);
 		// Compare the name of an activity with another
 		int compareName(activityData & passedActivity);
+		// Compare the name of an activity with a name
+		int compareName(char * passedName);
+		// Hash the name of an activity
+		unsigned int hashName();
+		// Set the collation used to order and match the name, rebuilding the sort key if it changes
+		int setCollation(int mode);
+		// Build just the sort key for a name, so this object can be used to search for that name
+		int loadKey(char * passedName, int mode, char keyBuffer[], int size);
         // Write the data for the activity to a file
-        int write(ofstream & outFile);
+        int write(ostream & outFile);
+		// Append the name of the activity to a front-coded name index
+		int writeName(nameBlockIndex & index);
+		// Write the activity data (other than the name) to a binary snapshot file
+		int writeRecord(ofstream & outFile);
+		// Write the name of the activity to a binary patch file
+		int writePatchName(ofstream & outFile);
+		// Determine if every field of an activity is exactly the same as another
+		bool sameAs(activityData & passedActivity);
+		// Write just the name of the activity to a stream
+		int writeName(ostream & out);
+		// Count the cost of the activity in a set of statistics
+		int addCostTo(catalogStatistics & statistics);
+		// Stop counting the cost of the activity in a set of statistics
+		int removeCostFrom(catalogStatistics & statistics);
 		
 	private:
 		char * name; // The name of the activity
 		char * description; // A description of the activity
 		char * equipment; // The equipment needed for the activity
 		float cost; // The cost of the activity
+		char * sortKey; // The name folded under the collation, which orders and matches activities
+		bool ownsKey; // Whether the sort key was allocated for this object, rather than sharing the name or a buffer
+		unsigned long long keyPrefix; // The first 8 bytes of the sort key, packed so they compare as one integer
+		int collation; // The collation the sort key was built with
+		// Build the sort key from the name, under the current collation
+		void buildKey();
+		// Pack the first bytes of the sort key into the key prefix
+		void packPrefix();
+		// Release the sort key, if this object allocated it
+		void releaseKey();
 };
 
 
+// The reservation policy of a location is stored as a combination of these flags, so that locations can be filtered
+// by policy with a single bitmask comparison. A location with no flags set does not take reservations at all. The
+// requirements the user enters as text are parsed into these flags by the parseReservation function.
+enum reservationFlag
+{
+	RESERVATION_NONE = 0, // No reservations are needed
+	RESERVATION_REQUIRED = 1, // Reservations are required
+	RESERVATION_RECOMMENDED = 2, // Reservations are recommended, but not required
+	RESERVATION_WEEKENDS = 4, // The policy only applies on weekends and holidays
+	RESERVATION_GROUPS = 8, // The policy only applies to groups
+	RESERVATION_PERMIT = 16, // A permit or pass is needed
+	RESERVATION_FEE = 32, // There is a fee
+	RESERVATION_UNKNOWN = 128 // The requirements entered could not be understood
+};
+
 // This struct will be a node in a list of locations that provide a certain activity. Each location
 // node will contain a description of the location, whether or not the location requires reservations, the number 
-// of parking spots available at the location, and a pointer to the next location node.
+// of parking spots available at the location, and a pointer to the next location node. The reservation requirements
+// are stored as a policy made of reservationFlag values. The text the user entered is only kept if it says more than
+// the policy does- if it is exactly the text formatReservation produces for the policy, no copy of it is stored.
 struct locationNode
 {
 	char * name; // The name of the location
 	char * description; // A description of the location
-	char * reservation; // Whether or not reservations are required at this location
+	char * reservationDetail; // The reservation requirements as entered, or null if they match the policy exactly
+	unsigned char reservationPolicy; // Whether or not reservations are required at this location
 	int numParkingSpots; // The number of parking spots at this location
+	int slot; // The position of this location's attributes in the location table
 	locationNode * next; // Pointer to the next location in the list of locations offering an activity
 };
 
@@ -67,6 +239,177 @@ struct activityNode
 	activityData activity; // Struct containing data on activity
 	locationNode * head; // Pointer to list of locations associated with this activity
 	activityNode * next; // Pointer to the next activity in the list
+	int numLocations; // The number of locations in the list of locations
+	long totalParking; // The number of parking spots across all of the locations
+};
+
+// This class will hold the attributes of every location in the list of activities in packed arrays, one array per
+// attribute, so that filtering the locations by reservation policy and parking only needs to scan a few bytes per
+// location, rather than following every activity's list of locations and comparing strings. Each location records
+// its position in the arrays (its slot). Removing a location moves the last location into its slot, so the arrays
+// never have gaps.
+class locationTable
+{
+	public:
+		locationTable();
+		~locationTable();
+		// Add a location belonging to this activity to the table
+		int add(locationNode * location, activityNode * owner);
+		// Remove a location from the table
+		int remove(locationNode * location);
+		// Remove every location from the table
+		int removeAll();
+		// Find the next slot at or after start whose location matches the filter, or -1 if there are no more
+		int findNext(int start, unsigned char policyMask, unsigned char policyValue, int minSpots);
+		// The location in a slot
+		locationNode * getLocation(int slot);
+		// The activity the location in a slot belongs to
+		activityNode * getActivity(int slot);
+		// The number of locations in the table
+		int getCount();
+
+	private:
+		unsigned char * policies; // The reservation policy of each location
+		int * parking; // The number of parking spots at each location
+		locationNode ** locations; // The location in each slot
+		activityNode ** owners; // The activity each location belongs to
+		int count; // The number of locations in the table
+		int capacity; // The number of slots allocated
+};
+
+// This struct will be a node in the order-statistic index over the list of activities. Each index node refers to one
+// activity node, and has a random number of levels. At each level, the node holds a pointer to the next index node
+// with at least that many levels, along with the width of that link- the number of activities it skips over.
+struct indexNode
+{
+	activityNode * activity; // The activity this index node refers to (null for the header and the tail)
+	int numLevels; // The number of levels this index node has
+	indexNode ** forward; // Pointers to the next index node at each level
+	int * width; // The number of activities skipped over by each forward pointer
+};
+
+// This class will be an indexable skip list over the activities in the list, kept in the same alphabetical order.
+// Since each link records how many activities it skips, the index can find an activity by name, find the activity
+// at a given position, and find the position (rank) of an activity, all in O(log n) time, without walking the list.
+// The index does not own the activity nodes it refers to- the activityList class is responsible for those.
+class activityIndex
+{
+	public:
+		activityIndex();
+		~activityIndex();
+		// Add an activity node to the index, and find the activity node it belongs after
+		int insert(activityNode * newActivity, activityNode * & previous);
+		// Remove the activity with this name from the index, and find the activity node before it
+		activityNode * remove(char * activityName, activityNode * & previous);
+		// Find the activity with this name
+		activityNode * find(char * activityName);
+		// Find the activity at this rank, counting from zero
+		activityNode * atRank(int rank);
+		// Find the rank of the activity with this name, or -1 if it is not found
+		int rankOf(char * activityName);
+		// Count the activities that come before this activity (or up to and including it, if inclusive)
+		int countBefore(activityData & passedActivity, bool inclusive);
+		// The number of activities in the index
+		int getCount();
+		// Remove all of the activities from the index
+		int removeAll();
+		// Set the collation the index is ordered by- only while the index is empty
+		int setCollation(int mode);
+		// The collation the index is ordered by
+		int getCollation();
+
+	private:
+		indexNode * header; // The node before the first activity, with the maximum number of levels
+		indexNode * tail; // The node after the last activity
+		int count; // The number of activities in the index
+		unsigned int seed; // State of the random number generator used to pick levels
+		int collation; // The collation the activities are ordered by
+		// Pick the number of levels for a new index node
+		int randomLevel();
+		// Find the last index node at each level that comes before an activity
+		int search(activityData & passedActivity, bool inclusive, indexNode * update[], int steps[]);
+};
+
+// This class will hold a position in the list of activities, so that the client program can page through the list
+// a few activities at a time. Rather than a pointer into the list, the cursor remembers a copy of the last activity
+// it passed over, so the cursor stays valid even when that activity (or any other) is added or removed- the next page
+// simply begins with the first activity that comes after it alphabetically.
+class activityCursor
+{
+	public:
+		activityCursor();
+		// Copy constructor: the copy remembers its own copy of the last activity
+		activityCursor(const activityCursor & passedCursor);
+		// Assignment: copy the position of another cursor
+		activityCursor & operator=(const activityCursor & passedCursor);
+		// The number of activities the cursor has passed over the last time it was used
+		int getPassed();
+
+	private:
+		activityData last; // A copy of the last activity the cursor passed over
+		bool atStart; // Whether the cursor is before the first activity in the list
+		int passed; // The number of activities before the cursor, as of the last time it was used
+		friend class activityList;
+};
+
+// This class will read a snapshot written by the writeSnapshot function of the activityList class one activity at a
+// time, so that a snapshot can be compared with another list without loading all of it at once. Only the front-coded
+// name index is held in memory the whole time, and it can be searched to find an activity in the snapshot by name. Each activity is returned as a new activity node, along with its list
+// of locations, which is not part of any activityList- the caller is responsible for releasing it.
+class snapshotReader
+{
+	public:
+		snapshotReader();
+		~snapshotReader();
+		// Open a snapshot file and read its header and name index
+		int open(char * fileName);
+		// Read the next activity and its locations, or return null at the end of the snapshot or on an error
+		activityNode * next();
+		// The collation the activities in the snapshot are ordered by
+		int getCollation();
+		// The number of activities in the snapshot
+		int getCount();
+		// Find the rank of the activity with this name in the snapshot, without reading any activities
+		int rankOf(char * activityName);
+		// Whether reading the snapshot failed because the file is not a valid snapshot
+		bool failed();
+
+	private:
+		ifstream inFile; // The snapshot file being read
+		nameBlockIndex names; // The names of all of the activities in the snapshot
+		int version; // The version of the snapshot format the file was written in
+		int collation; // The collation the activities in the snapshot are ordered by
+		int position; // The number of activities read so far
+		char * name; // Buffer holding the name of the activity being read
+		bool error; // Whether the file turned out not to be a valid snapshot
+};
+
+class activityList;
+
+// This class will walk the activities of one version of a list in order, for computing the changes between two
+// versions. The activities can come either from a live activityList, or from a snapshot file read one activity at a
+// time with a snapshotReader, so any two versions can be compared the same way.
+class deltaSource
+{
+	public:
+		// Walk the activities of a live list
+		deltaSource(activityList & passedList);
+		// Walk the activities of a snapshot as they are read
+		deltaSource(snapshotReader & passedReader);
+		~deltaSource();
+		// The activity the source is at, or null once every activity has been passed
+		activityNode * current();
+		// Move on to the next activity
+		int advance();
+		// The collation the activities are ordered by
+		int getCollation();
+		// Whether the activities could not all be read
+		bool failed();
+
+	private:
+		activityNode * node; // The activity the source is at
+		snapshotReader * reader; // The snapshot being read, or null when walking a live list
+		int collation; // The collation the activities are ordered by
 };
 
 // This class will represent our ADT and manage our LLL of snow activities. The member functions of this class will
@@ -94,25 +437,113 @@ class activityList
 		// Display all of the locations associated with an activitiy with this name
 		int displayLocations(char * activityName);
 		// Display the reservation requirements for this activity at this location
-		int displayReservation(char * activityName, char * locationName); 
+		int displayReservation(char * activityName, char * locationName, ostream & out = cout); 
 		// Remove an activity with this name from the list
 		int removeActivity(char * activityName);
         // Write the list to a file
         int writeToFile(char * fileName);
+		// Write the list to a stream, in the same format as writeToFile
+		int writeToStream(ostream & out);
+		// Build a front-coded index of the names of the activities in the list
+		int buildNameIndex(nameBlockIndex & index, int blockSize);
+		// Write the list to a binary snapshot file
+		int writeSnapshot(char * fileName);
+		// Replace the list with the contents of a binary snapshot file
+		int loadSnapshot(char * fileName);
+		// The number of activities in the list
+		int getCount();
+		// Find the rank of the activity with this name in the list, counting from zero
+		int rankOf(char * activityName);
+		// Copy the activity at this rank in the list
+		int seek(int rank, activityData & found);
+		// Move a cursor to just before the activity at this rank
+		int seekCursor(activityCursor & cursor, int rank);
+		// Display the next pageSize activities after a cursor, and move the cursor past them
+		int displayPage(activityCursor & cursor, int pageSize, ostream & out = cout);
+		// Write the activity with this name and its locations, in the same format as writeToFile
+		int lookup(char * activityName, ostream & out);
+		// Count the locations whose reservation policy and parking match a filter
+		int countLocations(unsigned char policyMask, unsigned char policyValue, int minSpots);
+		// Display the locations whose reservation policy and parking match a filter
+		int displayLocations(unsigned char policyMask, unsigned char policyValue, int minSpots, ostream & out = cout);
+		// Summarize the whole list of activities, without traversing it
+		int getSummary(catalogSummary & summary);
+		// Find the number of locations and parking spots for the activity with this name
+		int getActivitySummary(char * activityName, int & numLocations, long & totalParking);
+		// Change how the names of activities are ordered and matched, re-sorting the list
+		int setCollation(int mode);
+		// The collation the names of activities are ordered and matched by
+		int getCollation();
+		// Write a patch holding the changes that turn this list into another list
+		int writeDelta(activityList & newer, char * patchFile);
+		// Write a patch holding the changes that turn a snapshot into this list
+		int writeDeltaSince(char * snapshotFile, char * patchFile);
+		// Apply a patch written by one of the functions above to this list
+		int applyPatch(char * patchFile);
 
 
 
 	private:
 		activityNode * head; // Pointer to the first node in the list of activities
+		activityIndex index; // Order-statistic index over the activities in the list
+		locationTable locations; // Packed attributes of every location in the list
+		catalogStatistics statistics; // Running totals for the activities and locations in the list
 		// Recursive portion of displayAll
 		int displayAll(activityNode * head);
+		// Release all activities and locations in the list
+		int removeAll();
+		// Write one activity and its locations, in the format used by writeToFile
+		int writeActivity(activityNode * current, ostream & out);
+		// Allocate a new location for an activity, and add it to the location table
+		locationNode * createLocation(activityNode * owner, char * locationName, char * passedDescription, unsigned char policy, char * detail, int numSpots);
+		// Add a location to the location table and count it in the totals
+		void registerLocation(activityNode * owner, locationNode * location);
+		// Place an activity node read from a snapshot or patch, along with its locations, into the list
+		int adoptActivity(activityNode * newActivity);
+		// Read one change to the activity with this name from a patch file, and check that it fits the list or make it
+		int applyChange(ifstream & inFile, int change, char * name, bool apply);
+		// Remove a location from the location table and deallocate it
+		void releaseLocation(locationNode * location);
+		// Put a chain of activity nodes into the list and index under a collation, returning any that collide
+		activityNode * rebuildOrder(activityNode * chain, int mode);
+		// The sharded list merges the activities of several lists in alphabetical order
+		friend class shardedActivityList;
+		// Computing the changes between two lists walks each list in order
+		friend class deltaSource;
 };	
 
 
 
+// Fold a name into its sort key under a collation
+char * makeSortKey(const char * passedName, int collation);
+// Compare two names under a collation, returning a value with the same meaning as strcmp
+int collateCompare(const char * first, const char * second, int collation);
+// Write a patch holding the changes that turn one snapshot into another, reading both a little at a time
+int diffSnapshots(char * olderSnapshot, char * newerSnapshot, char * patchFile);
+// Hash a name- names that match under the collation always hash to the same value
+unsigned int hashName(const char * passedName, int collation = COLLATE_BINARY);
+// Parse reservation requirements entered as text into a reservation policy
+unsigned char parseReservation(const char * text);
+// Write the standard text for a reservation policy into a buffer
+int formatReservation(unsigned char policy, char buffer[], int size);
+// Write the reservation requirements of a location, exactly as they were entered
+void writeReservation(ostream & out, locationNode * location);
+// Display the data for a single location
+void displayLocation(ostream & out, locationNode * location);
+
 // Client Function prototypes:
 void displayMenu();
 void mainMenu(activityList & myList);
 void passActivityInfo(activityData & anActivity);
 void passLocationInfo(activityList & myList);
 void exportToFile(activityList & myList);
+void exportSnapshot(activityList & myList);
+void importSnapshot(activityList & myList);
+void browseActivities(activityList & myList);
+void filterLocations(activityList & myList);
+void displaySummary(activityList & myList);
+void changeCollation(activityList & myList);
+void exportPatch(activityList & myList);
+void importPatch(activityList & myList);
+
+#endif